@@ -0,0 +1,99 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <windows.h>
+#include <string>
+#include <cstdint>
+
+#include "scanner.hpp"
+
+namespace Cache
+{
+    /**
+     * @brief Relative address recorded for a signature that is not present in a module.
+     *
+     */
+    constexpr uint32_t NOT_PRESENT = UINT32_MAX;
+
+    /**
+     * @brief Identity of a game DLL as recorded in its PE headers.
+     * @details Two modules with the same name and identity are assumed to have the same contents,
+     *      so addresses found in one are valid in the other relative to the module base.
+     */
+    typedef struct identity_t {
+        std::string module;
+        uint32_t timeDateStamp;
+        uint32_t checkSum;
+        uint32_t sizeOfImage;
+    } identity_t;
+
+    /**
+     * @brief Build the identity of a loaded module from its PE headers
+     *
+     * @param name Name of the module, ie "hackGU_vol1.dll"
+     * @param module Base of the module
+     * @return identity_t
+     */
+    identity_t identify(const std::string& name, HMODULE module);
+
+    /**
+     * @brief Load the signature cache from disk
+     * @details A missing or corrupt file is treated as an empty cache.
+     *
+     * @param path Path to the cache file
+     */
+    void load(const std::string& path);
+
+    /**
+     * @brief Write the signature cache to the path given to `load`
+     *
+     */
+    void save();
+
+    /**
+     * @brief Look up the relative address a signature was found at in a module
+     *
+     * @param identity Identity of the module
+     * @param pattern Signature, its text and section hint together identify it
+     * @param rva Relative address of the first hit or `NOT_PRESENT`, only written on success
+     * @param hits Number of hits of the signature, only written on success
+     * @return true if the cache holds an entry for the signature in a module of this identity
+     */
+    bool lookup(const identity_t& identity, const Scanner::Pattern& pattern, uint32_t* rva, uint32_t* hits);
+
+    /**
+     * @brief Record the relative address a signature was found at in a module
+     * @details Entries of a module with the same name but a different identity, ie from before
+     *      a game update, are dropped.
+     *
+     * @param identity Identity of the module
+     * @param pattern Signature, its text and section hint together identify it
+     * @param rva Relative address of the first hit, or `NOT_PRESENT` if the signature has no hit
+     * @param hits Number of hits of the signature, more than one makes it ambiguous
+     */
+    void store(const identity_t& identity, const Scanner::Pattern& pattern, uint32_t rva, uint32_t hits);
+}
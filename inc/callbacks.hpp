@@ -0,0 +1,177 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "safetyhook.hpp"
+
+#include "hookstate.hpp"
+
+/**
+ * @brief Mid hook callbacks of the fixes and the values they read.
+ * @details The callbacks live on their own, away from the fixes installing them, so the hook
+ *      benchmark can replay recorded contexts through exactly the code that runs in the game.
+ */
+namespace Callbacks
+{
+    /**
+     * @brief Values the hook callbacks need, computed from the configuration by `deriveConstants`.
+     * @details The hooks run inside the game's frame loop, some of them for every UI element on
+     *      every frame, so they only load and compare these values instead of doing the math
+     *      themselves. Everything sits in a single cache line and shall be treated as read only
+     *      once published.
+     */
+    typedef struct alignas(64) derived_t {
+        float centerUiWidth;
+        float widthScalingFactor;
+        float aspectRatio;
+        float normalizedAspectRatio;
+        uintptr_t viewportWidth;
+        uint32_t uiWidth;
+        uint32_t mapOffset0;
+        uint32_t mapOffset1;
+        uint32_t mapOffsetCorrected;
+        uint32_t combatOverlayScale;
+        uint32_t resolutionHeight;
+        bool combatOverlayEnable;
+        bool masterEnable;
+    } derived_t;
+    static_assert(sizeof(derived_t) == 64);
+
+    /**
+     * @brief Values passed from the first text bubble hook to the second one.
+     * @details Published as one pair through `textBubbleScaler`, the second hook never sees the
+     *      `corrected` value of one publish together with the `gameCalculated` of another.
+     */
+    typedef struct textBubbleScaler_t {
+        float gameCalculated;
+        float corrected;
+    } textBubbleScaler_t;
+
+    /**
+     * @brief Published `derived_t` block, see `publishDerived`.
+     * @details Stubs load it themselves, everything else goes through `loadDerived`.
+     */
+    extern std::atomic<const derived_t*> derivedCurrent;
+
+    extern HookState::Shared<textBubbleScaler_t> textBubbleScaler;
+
+    /**
+     * @brief Gets the currently published `derived_t` block.
+     * @details Must be loaded once per hook call and not kept around, this is a plain load on x86.
+     *
+     * @return const derived_t&
+     */
+    inline const derived_t& loadDerived() {
+        return *derivedCurrent.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Makes a `derived_t` block the one the hook callbacks read.
+     * @details The block is copied into the next of `DERIVED_SLOTS` slots and `derivedCurrent` is
+     *      swapped over to it, hooks that are running keep reading the previous block and the next
+     *      hook call sees the new one. A slot is only written again after `DERIVED_SLOTS - 1`
+     *      further publishes, by then no hook can still be reading from it as a hook holds the
+     *      pointer for a single call and configuration reloads are far apart. Must only be called
+     *      from one thread.
+     *
+     * @param next Block to publish
+     */
+    void publishDerived(const derived_t& next);
+
+    constexpr size_t DERIVED_SLOTS = 4;
+
+    /**
+     * @brief Per fix switch that turns its hooks into a pass through while they stay installed.
+     * @details A fix is off while its byte is 0. Every callback and stub loads its byte first,
+     *      so a single store turns a fix on or off without creating or destroying any hook.
+     */
+    typedef struct alignas(64) toggles_t {
+        std::atomic<uint8_t> centerUi{ 1 };
+        std::atomic<uint8_t> viewport{ 1 };
+        std::atomic<uint8_t> textBubblePlacement{ 1 };
+        std::atomic<uint8_t> combatOverlay{ 1 };
+        std::atomic<uint8_t> uiElements{ 1 };
+        std::atomic<uint8_t> cutscene{ 1 };
+        std::atomic<uint8_t> constrainAntiAliasing{ 1 };
+    } toggles_t;
+    static_assert(sizeof(std::atomic<uint8_t>) == 1);
+
+    extern toggles_t toggles;
+
+    inline bool enabled(const std::atomic<uint8_t>& toggle) {
+        return toggle.load(std::memory_order_relaxed) != 0;
+    }
+
+    void centerUi(SafetyHookContext& ctx);
+    void viewport(SafetyHookContext& ctx);
+    void textBubblePlacement0(SafetyHookContext& ctx);
+    void textBubblePlacement1(SafetyHookContext& ctx);
+    void combatOverlay(SafetyHookContext& ctx);
+    void uiElements(SafetyHookContext& ctx);
+    void cutscene(SafetyHookContext& ctx);
+    void constrainAntiAliasing(SafetyHookContext& ctx);
+
+    constexpr size_t MAX_WINDOW = 64;
+
+    /**
+     * @brief Game memory a callback reads or writes, relative to one of its registers.
+     * @details `reg` is null for callbacks that only touch registers.
+     */
+    typedef struct window_t {
+        uintptr_t SafetyHookContext::* reg;
+        int32_t displacement;
+        uint32_t size;
+    } window_t;
+
+    /**
+     * @brief A callback together with the game memory it touches.
+     */
+    typedef struct site_t {
+        const char* name;
+        safetyhook::MidHookFn callback;
+        window_t window;
+    } site_t;
+
+    /**
+     * @brief Every callback, used to record and replay hook contexts.
+     */
+    constexpr std::array<site_t, 8> sites = {{
+        { "centerUi",              centerUi,              { nullptr,                 0,     0    } },
+        { "viewport",              viewport,              { nullptr,                 0,     0    } },
+        { "textBubblePlacement0",  textBubblePlacement0,  { &SafetyHookContext::rbx, 0x4,   4    } },
+        { "textBubblePlacement1",  textBubblePlacement1,  { nullptr,                 0,     0    } },
+        { "combatOverlay",         combatOverlay,         { &SafetyHookContext::rdx, 0x280, 0x34 } },
+        { "uiElements",            uiElements,            { &SafetyHookContext::rbx, 0x388, 0x10 } },
+        { "cutscene",              cutscene,              { &SafetyHookContext::rsp, 0x38,  8    } },
+        { "constrainAntiAliasing", constrainAntiAliasing, { &SafetyHookContext::rdx, 0x10,  1    } },
+    }};
+}
@@ -0,0 +1,137 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "safetyhook.hpp"
+#include "callbacks.hpp"
+
+/**
+ * @brief Hook context recording, only built with the `HOOK_CAPTURE` CMake option.
+ * @details Every `HOOK_CAPTURE_STRIDE`th call of a callback in `Callbacks::sites` is recorded,
+ *      the registers and the game memory of its `window_t` right before and right after the
+ *      callback ran. The recording is written to a file the hook benchmark replays, the
+ *      outputs recorded in the game are what every replay has to reproduce bit for bit.
+ */
+namespace Capture
+{
+    constexpr uint32_t FILE_MAGIC = 0x43554748; // "HGUC"
+    constexpr uint32_t FILE_VERSION = 2;
+    constexpr size_t MAX_SAMPLES = 1024;
+
+    /**
+     * @brief Every switch of `Callbacks::toggles_t`, in the order they are kept in `sample_t::toggles`.
+     *
+     */
+    constexpr std::array<std::atomic<uint8_t> Callbacks::toggles_t::*, 7> TOGGLES = {
+        &Callbacks::toggles_t::centerUi,
+        &Callbacks::toggles_t::viewport,
+        &Callbacks::toggles_t::textBubblePlacement,
+        &Callbacks::toggles_t::combatOverlay,
+        &Callbacks::toggles_t::uiElements,
+        &Callbacks::toggles_t::cutscene,
+        &Callbacks::toggles_t::constrainAntiAliasing,
+    };
+    constexpr size_t MAX_TOGGLES = 8;
+    static_assert(TOGGLES.size() <= MAX_TOGGLES);
+
+    /**
+     * @brief Start of a capture file, followed by `count` samples.
+     * @details `derived` is the block that was published when the file was written, a
+     *      configuration reload while recording makes the samples before it fail to replay.
+     */
+    typedef struct header_t {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t sampleSize;
+        uint32_t count;
+        Callbacks::derived_t derived;
+    } header_t;
+
+    /**
+     * @brief A single recorded call of a callback.
+     * @details `windowValid` is false when the window could not be read, the callback is then
+     *      expected not to touch it, ie the guard of `Callbacks::combatOverlay` was not taken.
+     *      `toggles` holds `Callbacks::toggles` as they were for this call, in the order of
+     *      `TOGGLES`, they can be switched while recording.
+     */
+    typedef struct sample_t {
+        uint32_t site;
+        uint32_t windowValid;
+        SafetyHookContext before;
+        SafetyHookContext after;
+        uint8_t windowBefore[Callbacks::MAX_WINDOW];
+        uint8_t windowAfter[Callbacks::MAX_WINDOW];
+        Callbacks::textBubbleScaler_t scalerBefore;
+        Callbacks::textBubbleScaler_t scalerAfter;
+        uint8_t toggles[MAX_TOGGLES];
+    } sample_t;
+
+    /**
+     * @brief Copy the current `Callbacks::toggles` into `toggles`, in the order of `TOGGLES`
+     *
+     * @param toggles Receives `TOGGLES.size()` bytes
+     */
+    inline void saveToggles(uint8_t* toggles) {
+        for (size_t i = 0; i < TOGGLES.size(); ++i) {
+            toggles[i] = (Callbacks::toggles.*TOGGLES[i]).load(std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Set `Callbacks::toggles` to what `saveToggles` recorded
+     *
+     * @param toggles `TOGGLES.size()` bytes
+     */
+    inline void restoreToggles(const uint8_t* toggles) {
+        for (size_t i = 0; i < TOGGLES.size(); ++i) {
+            (Callbacks::toggles.*TOGGLES[i]).store(toggles[i], std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Wrap a mid hook callback so its calls are recorded
+     *
+     * @param hook Callback to wrap
+     * @return Recording callback, or `hook` itself if it is not in `Callbacks::sites`
+     */
+    safetyhook::MidHookFn wrap(safetyhook::MidHookFn hook);
+
+    /**
+     * @brief Write every sample recorded so far to a file
+     * @details Samples are kept for the whole session, every save rewrites the file with all
+     *      of them. Recording stops for a site once it has `MAX_SAMPLES` samples.
+     *
+     * @param path Path of the capture file
+     * @return Number of samples written
+     */
+    size_t save(const char* path);
+}
@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <windows.h>
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief Monitors attached to the desktop and the one the game runs on.
+ * @details Monitors are enumerated once and cached, the cache is only thrown away when Windows
+ *      reports a display change. The fix and the patch tool resolve the resolution through the
+ *      same rules so both agree on what a width or height of 0 means.
+ */
+namespace Display
+{
+    /**
+     * @brief A single monitor as part of the desktop.
+     * @details `bounds` is in virtual desktop coordinates. A spanned surround setup that the
+     *      driver presents as one display is a single monitor with the full width.
+     */
+    typedef struct monitor_t {
+        HMONITOR handle;
+        RECT bounds;
+        int width;
+        int height;
+        int refreshRate;
+        bool primary;
+    } monitor_t;
+
+    /**
+     * @brief Get every monitor, primary first and then left to right
+     * @details Enumerated on the first call and after every `invalidate`.
+     *
+     * @return const std::vector<monitor_t>&
+     */
+    const std::vector<monitor_t>& monitors();
+
+    /**
+     * @brief Throw away the cached monitors, the next `monitors` enumerates them again
+     *
+     */
+    void invalidate();
+
+    /**
+     * @brief Pick the monitor the resolution is taken from
+     * @details `index` 1 and up picks that monitor in the order of `monitors`, the same in the fix
+     *      and the patch tool. 0 picks the monitor `window` is on, or the primary monitor without a
+     *      window, which is what the patch tool always gets as the game is not running then. An
+     *      index past the last monitor is treated as 0.
+     *
+     * @param index Monitor setting from the YAML file
+     * @param window Game window, or NULL
+     * @return monitor_t
+     */
+    monitor_t resolve(int index, HWND window);
+
+    /**
+     * @brief Find the main window of the game
+     * @details The largest visible top level window of this process that is not one of ours.
+     *
+     * @return HWND or NULL if the game has not created it yet
+     */
+    HWND findGameWindow();
+
+    /**
+     * @brief Start watching for display changes and for the game window changing monitor
+     * @details A hidden window on its own thread receives `WM_DISPLAYCHANGE`, after which the
+     *      cached monitors are dropped and `changed` is called. `changed` is also called when
+     *      the game window is shown or moved onto a different monitor. Called on the watching
+     *      thread, it must not block.
+     *
+     * @param changed Called after the displays or the monitor of the game window changed
+     * @return true if watching started
+     */
+    bool start(void (*changed)());
+}
@@ -0,0 +1,113 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "cache.hpp"
+
+/**
+ * @brief Report of how every fix resolved its signatures in each game DLL.
+ * @details Written as JSON after the fixes are applied to a game DLL, so after a game update it
+ *      shows at a glance which fixes fell back to another signature, which ones are ambiguous and
+ *      which are gone, instead of a trail of log lines.
+ */
+namespace Health
+{
+    /**
+     * @brief What became of a single fix.
+     * @details `Resolved` fixes were applied at the only hit of their signature, `Fallback` fixes
+     *      at the only hit of one of their fallback signatures. `Ambiguous` fixes have no signature
+     *      with a single hit and were applied at the first hit of their signature. `Missing` fixes
+     *      have no hit at all and were not applied. `Disabled` and `Unused` fixes were not scanned
+     *      for, being switched off in the YAML file or not part of the game DLL.
+     */
+    enum class Status {
+        Resolved,
+        Fallback,
+        Ambiguous,
+        Missing,
+        Disabled,
+        Unused,
+    };
+
+    /**
+     * @brief Outcome of scanning for a single signature.
+     * @details `cached` signatures were confirmed at the address in the signature cache instead
+     *      of being scanned for, `hits` is then the count recorded when they were scanned for.
+     */
+    typedef struct signature_t {
+        const char* text;
+        uint32_t hits;
+        bool cached;
+    } signature_t;
+
+    /**
+     * @brief A single fix, `signatures` are in the order they were tried.
+     * @details `signature` is the index of the signature the fix was applied at and `rva` the
+     *      address relative to the game DLL base it was applied at, including its offset.
+     */
+    typedef struct fix_t {
+        const char* name;
+        Status status;
+        size_t signature;
+        uint32_t rva;
+        std::vector<signature_t> signatures;
+    } fix_t;
+
+    /**
+     * @brief All fixes of a single load of a game DLL.
+     * @details `scanMicroseconds` covers every signature of every fix as they are scanned for in
+     *      a single pass.
+     */
+    typedef struct report_t {
+        Cache::identity_t identity;
+        uint64_t scanMicroseconds;
+        std::vector<fix_t> fixes;
+    } report_t;
+
+    /**
+     * @brief Get the name of a status as it is written to the report
+     *
+     * @param status Status
+     * @return const char*
+     */
+    const char* toString(Status status);
+
+    /**
+     * @brief Record the report of a game DLL and write the reports of every game DLL to a file
+     * @details The file holds one JSON object keyed by game DLL name, each game DLL is on a single
+     *      line. The report of a game DLL replaces its previous one, it is not written again when
+     *      its hook plan is replayed.
+     *
+     * @param path Path to the report file
+     * @param report Report of the game DLL that just loaded
+     * @return true if the file was written
+     */
+    bool save(const std::string& path, const report_t& report);
+}
@@ -0,0 +1,108 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Log from inside a hook callback.
+ * @details Never allocates, locks or touches the disk. Each call site logs at most once per
+ *      `HookLog::RATE_LIMIT`, calls in between are counted and reported with the next line.
+ */
+#define HOOK_LOG(STRING, ...) \
+    do { \
+        static constinit HookLog::limiter_t hookLogLimiter; \
+        HookLog::write(&hookLogLimiter, "{} : " STRING, __func__, ##__VA_ARGS__); \
+    } while (0)
+
+/**
+ * @brief Logging for code that runs on game threads.
+ * @details Every thread that logs claims a fixed ring of lines from a static pool the first time
+ *      it logs, lines are formatted into a stack buffer and copied into the ring. A background
+ *      thread drains all rings into the asynchronous spdlog logger. A full ring or an exhausted
+ *      pool drops the line instead of waiting, dropped lines are counted and reported.
+ */
+namespace HookLog
+{
+    constexpr size_t LINE_SIZE = 256;
+    constexpr std::chrono::milliseconds RATE_LIMIT{ 1000 };
+
+    /**
+     * @brief Per call site rate limiter of `HOOK_LOG`
+     *
+     */
+    typedef struct limiter_t {
+        std::atomic<int64_t> next{ 0 };
+        std::atomic<uint32_t> suppressed{ 0 };
+    } limiter_t;
+
+    /**
+     * @brief Check whether a call site may log now
+     *
+     * @param limiter Limiter of the call site
+     * @param suppressed Receives the number of lines suppressed since the last allowed one
+     * @return true if the line shall be logged
+     */
+    bool allow(limiter_t* limiter, uint32_t* suppressed);
+
+    /**
+     * @brief Queue a formatted line into the ring of the calling thread
+     *
+     * @param line Line to queue, does not need to be null terminated
+     * @param size Length of `line`
+     */
+    void push(const char* line, size_t size);
+
+    /**
+     * @brief Format and queue a line, use `HOOK_LOG` instead of calling this directly
+     *
+     */
+    template <typename... Args>
+    void write(limiter_t* limiter, std::format_string<Args...> format, Args&&... args) {
+        uint32_t suppressed = 0;
+        if (!allow(limiter, &suppressed)) {
+            return;
+        }
+        char line[LINE_SIZE];
+        size_t size = std::format_to_n(line, LINE_SIZE, format, std::forward<Args>(args)...).out - line;
+        if (suppressed > 0 && size < LINE_SIZE) {
+            size = std::format_to_n(line + size, LINE_SIZE - size, " ({} suppressed)", suppressed).out - line;
+        }
+        push(line, size);
+    }
+
+    /**
+     * @brief Start the thread draining the rings into the default spdlog logger
+     *
+     * @param interval Time between drains
+     */
+    void start(std::chrono::milliseconds interval);
+}
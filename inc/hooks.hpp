@@ -0,0 +1,121 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <windows.h>
+#include <cstddef>
+#include <memory>
+
+#include "safetyhook.hpp"
+
+namespace Hooks
+{
+    /**
+     * @brief Reserve the executable memory arena of a module
+     * @details Every module gets its own `safetyhook::Allocator`, all trampolines and stubs of its
+     *      hooks are taken from it. Reserving takes the first block of the arena right next to
+     *      the module as soon as it loads, so its hooks are packed together close to the code they
+     *      hook instead of wherever free memory is found at the time each hook is made.
+     *
+     * @param owner Module to reserve the arena for
+     * @return true if memory close to the module was reserved
+     */
+    bool reserve(HMODULE owner);
+
+    /**
+     * @brief Get the executable memory arena of a module
+     * @details The arena is created if `reserve` was not called for the module. It is released
+     *      together with the hooks of the module by `release`.
+     *
+     * @param owner Module the hooks are installed into
+     * @return std::shared_ptr<safetyhook::Allocator>
+     */
+    std::shared_ptr<safetyhook::Allocator> arena(HMODULE owner);
+
+    /**
+     * @brief Register a hook as owned by a module
+     * @details The hook lives until `release` is called for its owning module.
+     *
+     * @param owner Module the hook was installed into
+     * @param hook Hook to take ownership of
+     */
+    void add(HMODULE owner, SafetyMidHook&& hook);
+
+    /**
+     * @brief Register a stub hook as owned by a module
+     * @details The hook lives until `release` is called for its owning module. The inline hook
+     *      is always destroyed before the stub memory it jumps to is freed.
+     *
+     * @param owner Module the hook was installed into
+     * @param hook Inline hook redirecting to the stub
+     * @param code Executable memory holding the stub
+     */
+    void add(HMODULE owner, SafetyHookInline&& hook, safetyhook::Allocation&& code);
+
+    /**
+     * @brief Register a guarded stub hook as owned by a module
+     * @details The hook lives until `release` is called for its owning module. The inline hook
+     *      is destroyed first, then the mid hook placed in the stub, then the stub memory is freed.
+     *
+     * @param owner Module the hook was installed into
+     * @param hook Inline hook redirecting to the stub
+     * @param midHook Mid hook inside the stub
+     * @param code Executable memory holding the stub
+     */
+    void add(HMODULE owner, SafetyHookInline&& hook, SafetyMidHook&& midHook, safetyhook::Allocation&& code);
+
+    /**
+     * @brief Destroy every hook owned by a module
+     * @details Destroying a hook writes the original bytes back to the hooked location. Once all
+     *      hooks are gone the arena of the module is dropped, which frees the memory of every
+     *      trampoline and stub in one go. This must be called while the module is still mapped,
+     *      ie from the window `Watcher::release` describes, so the original bytes land in the
+     *      module that is going away and never in whatever gets mapped at that address next.
+     *
+     * @param owner Module the hooks were installed into
+     * @return Number of hooks destroyed
+     */
+    size_t release(HMODULE owner);
+
+    /**
+     * @brief Forget every hook owned by a module without touching the module
+     * @details For a module that may already be unmapped, restoring the original bytes would write
+     *      into whatever is mapped there now. The hooks and their arena are leaked instead, they
+     *      are small and this only happens when `Watcher::claim` fails.
+     *
+     * @param owner Module the hooks were installed into
+     * @return Number of hooks forgotten
+     */
+    size_t abandon(HMODULE owner);
+
+    /**
+     * @brief Get the number of hooks currently owned by a module
+     *
+     * @param owner Module the hooks were installed into
+     * @return size_t
+     */
+    size_t count(HMODULE owner);
+}
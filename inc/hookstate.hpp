@@ -0,0 +1,85 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @brief State handed from one hook to another.
+ * @details Hooks of a multi-stage fix may run on any of the game's threads, so values passed
+ *      between them must not tear and must not cost a lock in the frame loop.
+ */
+namespace HookState
+{
+    constexpr size_t CACHE_LINE = 64;
+
+    /**
+     * @brief A value published by one hook and read by another.
+     * @details The value is kept as a single 64-bit word so a reader always sees one whole
+     *      publish and never half of two, loads and stores are plain moves on x86. Every
+     *      `Shared` has a cache line to itself so publishing does not invalidate the line of
+     *      values other hooks are reading, ie the published `derived_t` block. Stubs may read the
+     *      word directly at the address of the `Shared`, they must load all 8 bytes at once.
+     *
+     * @tparam T Trivially copyable value of at most 8 bytes
+     */
+    template <typename T>
+    class alignas(CACHE_LINE) Shared {
+        static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(uint64_t));
+
+    public:
+        /**
+         * @brief Publish a value
+         *
+         * @param value Value to publish
+         * @param order Use `std::memory_order_relaxed` when nothing else is handed over with it
+         */
+        void store(const T& value, std::memory_order order = std::memory_order_release) {
+            uint64_t bits = 0;
+            std::memcpy(&bits, &value, sizeof(T));
+            word.store(bits, order);
+        }
+
+        /**
+         * @brief Read the last published value
+         *
+         * @param order Use `std::memory_order_relaxed` when nothing else is handed over with it
+         * @return T
+         */
+        T load(std::memory_order order = std::memory_order_acquire) const {
+            uint64_t bits = word.load(order);
+            T value;
+            std::memcpy(&value, &bits, sizeof(T));
+            return value;
+        }
+
+    private:
+        std::atomic<uint64_t> word{ 0 };
+    };
+}
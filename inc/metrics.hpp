@@ -0,0 +1,98 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "safetyhook.hpp"
+
+/**
+ * @brief Count a guard condition of a hook callback and evaluate to it.
+ * @details With hook metrics compiled out this is just the condition itself.
+ */
+#ifdef HOOK_METRICS
+#define METRICS_GUARD(CONDITION) Metrics::guard(CONDITION)
+#else
+#define METRICS_GUARD(CONDITION) (CONDITION)
+#endif
+
+/**
+ * @brief Hook instrumentation, only built with the `HOOK_METRICS` CMake option.
+ * @details Every instrumented hook gets a site. Each thread that fires a hook keeps its own
+ *      counters for every site so the hot path never locks or does atomic read-modify-writes,
+ *      the counters are only summed up when a summary is logged.
+ */
+namespace Metrics
+{
+    constexpr size_t MAX_SITES = 128;
+
+    /**
+     * @brief Wrap a mid hook callback so every call is counted and timed
+     * @details Sites are keyed by `name` and `hook`, wrapping the same callback under the same
+     *      name again, ie when a hook plan is replayed, keeps adding to the same site.
+     *
+     * @param name Name of the site shown in the summary
+     * @param hook Callback to wrap
+     * @return Instrumented callback, or `hook` itself if all sites are taken
+     */
+    safetyhook::MidHookFn wrap(const char* name, safetyhook::MidHookFn hook);
+
+    /**
+     * @brief Count a guard condition of the hook currently running on this thread
+     *
+     * @param taken Result of the guard condition
+     * @return `taken`
+     */
+    bool guard(bool taken);
+
+    /**
+     * @brief Log calls per second, p50 and p99 cycles and guard hit rate of every site
+     * @details Rates and percentiles cover the time since the previous summary.
+     *
+     * @param reason Shown in the header of the summary
+     */
+    void dump(const char* reason);
+
+    /**
+     * @brief Get the cycles spent in all sites on all threads since startup
+     * @details Sums the running total every thread keeps of its own sites. The threads are
+     *      published to an append only array, so it never locks and can be called from a hook
+     *      such as the telemetry present hook. Only the first 256 threads that fire a hook are
+     *      counted.
+     *
+     * @return uint64_t
+     */
+    uint64_t totalCycles();
+
+    /**
+     * @brief Start a thread logging a summary every `intervalSeconds`
+     *
+     * @param intervalSeconds Seconds between summaries
+     */
+    void start(uint32_t intervalSeconds);
+}
@@ -0,0 +1,143 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <windows.h>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace Patch
+{
+    /**
+     * @brief IDA-style byte array parsed at compile time
+     * @details `Patch::Bytes bytes("DE AD BE EF");` holds the 4 bytes without any parsing at
+     *      runtime, a malformed string fails to compile. Wildcards are not allowed.
+     */
+    template <size_t N>
+    struct Bytes {
+        uint8_t data[N] = {};
+        size_t size = 0;
+
+        consteval Bytes(const char (&pattern)[N]) {
+            auto nibble = [](char c) -> uint8_t {
+                if (c >= '0' && c <= '9') return c - '0';
+                if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+                if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+                throw "Patch::Bytes expects hex digits";
+            };
+            for (size_t i = 0; i + 1 < N; ) {
+                if (pattern[i] == ' ') {
+                    i++;
+                    continue;
+                }
+                data[size++] = (nibble(pattern[i]) << 4) | nibble(pattern[i + 1]);
+                i += 2;
+            }
+        }
+    };
+
+    /**
+     * @brief A set of memory edits applied together
+     * @details Edits are only recorded by `add`. `commit` groups them by page, changes the
+     *      protection of every run of pages once, writes all edits, restores the protection of
+     *      every run and flushes the instruction cache once for the whole set. Pages that are
+     *      already writable are left alone. If the protection of any run cannot be changed
+     *      nothing is written. The original bytes are kept so a committed set can be undone
+     *      with `rollback`.
+     */
+    class Transaction {
+    public:
+        /**
+         * @brief Record an edit
+         *
+         * @param address Address to write to
+         * @param bytes Bytes to write, copied
+         * @param size Number of bytes to write
+         */
+        void add(uintptr_t address, const void* bytes, size_t size);
+
+        /**
+         * @brief Record an edit parsed at compile time
+         *
+         * @param address Address to write to
+         * @param bytes Bytes to write, copied
+         */
+        template <size_t N>
+        void add(uintptr_t address, const Bytes<N>& bytes) {
+            add(address, bytes.data, bytes.size);
+        }
+
+        /**
+         * @brief Apply every recorded edit
+         *
+         * @return true if all edits were written, false if none were
+         */
+        bool commit();
+
+        /**
+         * @brief Write back the bytes that were overwritten by `commit`
+         *
+         * @return true if all edits were undone
+         */
+        bool rollback();
+
+        /**
+         * @brief Number of recorded edits
+         *
+         */
+        size_t size() const { return m_edits.size(); }
+
+        /**
+         * @brief Number of page runs whose protection had to be changed by the last commit
+         *
+         */
+        size_t protectedRuns() const { return m_protectedRuns; }
+
+    private:
+        // Edits up to this size, ie every patch of the fixes, are kept in place without allocating
+        static constexpr size_t INLINE_SIZE = 16;
+
+        typedef struct edit_t {
+            uintptr_t address;
+            size_t size;
+            uint8_t inlineBytes[INLINE_SIZE];
+            uint8_t inlineOriginal[INLINE_SIZE];
+            // Bytes followed by the original bytes of larger edits
+            std::vector<uint8_t> heap;
+
+            uint8_t* bytes() { return size <= INLINE_SIZE ? inlineBytes : heap.data(); }
+            uint8_t* original() { return size <= INLINE_SIZE ? inlineOriginal : heap.data() + size; }
+        } edit_t;
+
+        bool write(bool original);
+
+        std::vector<edit_t> m_edits;
+        size_t m_protectedRuns = 0;
+        bool m_committed = false;
+    };
+}
@@ -0,0 +1,76 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+#include "scanner.hpp"
+
+namespace Resolution
+{
+    constexpr size_t TABLE_ENTRIES = 15;
+
+    /**
+     * @brief A single entry of the resolution table as laid out in the game DLL's
+     *
+     */
+    typedef struct entry_t {
+        uint32_t width;
+        uint32_t height;
+    } entry_t;
+
+    typedef std::array<entry_t, TABLE_ENTRIES> table_t;
+    static_assert(sizeof(table_t) == TABLE_ENTRIES * 8);
+
+    /**
+     * @brief The resolution table as it ships in every game DLL.
+     * @details The game indexes into this table very early on during initialization to set up
+     *      the game window and various other calculations based off that resolution. The entries
+     *      are 800x600 all the way up to 3840x2160.
+     */
+    constexpr Scanner::Signature originalTable(
+        "20 03 00 00 58 02 00 00    00 04 00 00 00 03 00 00    00 05 00 00 D0 02 00 00 "
+        "00 05 00 00 20 03 00 00    00 05 00 00 00 04 00 00    50 05 00 00 00 03 00 00 "
+        "A0 05 00 00 84 03 00 00    40 06 00 00 84 03 00 00    40 06 00 00 B0 04 00 00 "
+        "90 06 00 00 1A 04 00 00    80 07 00 00 38 04 00 00    80 07 00 00 B0 04 00 00 "
+        "00 0A 00 00 A0 05 00 00    00 0A 00 00 40 06 00 00    00 0F 00 00 70 08 00 00",
+        Scanner::Section::Data
+    );
+    static_assert(originalTable.size == sizeof(table_t));
+
+    /**
+     * @brief Build a resolution table with every entry set to the same resolution
+     * @details Whatever entry the game picks it ends up with the desired resolution.
+     *
+     * @param width Width in pixels
+     * @param height Height in pixels
+     * @return table_t
+     */
+    table_t makeTable(uint32_t width, uint32_t height);
+}
@@ -0,0 +1,308 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace Scanner
+{
+    /**
+     * @brief Compare engines available to the scanner.
+     * @details `Auto` resolves to the fastest engine the CPU supports, which is decided once at
+     *      runtime through CPUID. `Sse2` is always available on x86_64, `Avx2` requires both CPU
+     *      and OS support. `Scalar` is the plain byte by byte fallback.
+     */
+    enum class Engine {
+        Auto,
+        Scalar,
+        Sse2,
+        Avx2,
+    };
+
+    /**
+     * @brief Kind of image section a signature may live in.
+     * @details Used both as the hint of a signature and as the kind of a scanned region. A
+     *      signature with the `Any` hint is searched for in every region, otherwise only in
+     *      regions of the same kind. Regions that are neither code nor data, ie the headers or
+     *      resources, are of kind `Any`.
+     */
+    enum class Section {
+        Any,
+        Code,
+        Data,
+    };
+
+    /**
+     * @brief Rough frequency rank of bytes in x86_64 code and data, most common first.
+     * @details Anything not listed is treated as rare. Picking anchors that are rare keeps the
+     *      number of candidates that need a full verify low.
+     */
+    constexpr uint8_t commonBytes[] = {
+        0x00, 0xFF, 0x48, 0x8B, 0x89, 0xCC, 0x0F, 0x24, 0x44, 0x4C, 0x8D, 0xE8, 0x85, 0x83,
+        0x01, 0xC0, 0x74, 0x75, 0x45, 0x41, 0x49, 0x10, 0x08, 0x20, 0xC3, 0x33, 0x05, 0x40,
+        0x04, 0x02, 0x03, 0x80, 0xF3, 0x90, 0xE9, 0x50, 0x18, 0x28, 0x30, 0x38, 0x4D, 0xC7,
+        0x66, 0x11, 0x0D, 0xEB, 0x3B, 0x5C, 0x54, 0x64, 0xC1, 0x39, 0x84, 0x8E, 0x0C, 0x14,
+    };
+
+    constexpr std::array<uint8_t, 256> byteRarity = [] {
+        std::array<uint8_t, 256> rarity{};
+        for (size_t i = 0; i < sizeof(commonBytes); ++i) {
+            rarity[commonBytes[i]] = (uint8_t)(sizeof(commonBytes) - i);
+        }
+        return rarity;
+    }();
+
+    constexpr int hexDigit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    constexpr bool isSeparator(char c) {
+        return c == ' ' || c == '\t';
+    }
+
+    /**
+     * @brief View of a parsed signature, this is what the engines scan for.
+     * @details `bytes` and `mask` are `size` long, a wildcard is stored as a 0x00 byte with a 0x00
+     *      mask and a fixed byte has a 0xFF mask. `anchor` and `anchor2` are the offsets of the two
+     *      rarest fixed bytes in the signature, these are the bytes the vectorized engines compare
+     *      against to find candidates before verifying the rest. `section` is the kind of section
+     *      the signature is expected to live in and `text` the signature it was parsed from. A
+     *      pattern does not own its bytes, it is only valid as long as the `Signature` it was
+     *      taken from.
+     */
+    typedef struct Pattern {
+        const char* text;
+        const uint8_t* bytes;
+        const uint8_t* mask;
+        size_t size;
+        size_t anchor;
+        size_t anchor2;
+        bool wildcardOnly;
+        Section section;
+    } Pattern;
+
+    /**
+     * @brief An IDA-style signature parsed into fixed size arrays.
+     * @details Tokens are separated by any amount of whitespace. A token is either a two digit
+     *      hex byte or a wildcard written as "?" or "??". Constructed from a string literal the
+     *      whole signature is parsed and its anchors are picked at compile time, a malformed
+     *      literal does not compile:
+     *
+     * @code
+     * constexpr Scanner::Signature signature("48 8B ?? 24 38", Scanner::Section::Code);
+     * Scanner::scan(data, size, signature.pattern(), &address);
+     * @endcode
+     *
+     * A signature only known at runtime is parsed with `assign`, or `parse`, into a signature
+     * with enough capacity for it.
+     *
+     * @tparam N Maximum number of bytes, for literals this is the length of the literal
+     */
+    template <size_t N>
+    struct Signature {
+        const char* text = nullptr;
+        uint8_t bytes[N] = {};
+        uint8_t mask[N] = {};
+        size_t size = 0;
+        size_t anchor = 0;
+        size_t anchor2 = 0;
+        bool wildcardOnly = true;
+        Section section = Section::Any;
+
+        constexpr Signature() = default;
+
+        consteval Signature(const char (&signature)[N], Section kind = Section::Any) {
+            if (!assign(signature, kind)) {
+                throw "Malformed signature";
+            }
+        }
+
+        /**
+         * @brief Parse a signature
+         *
+         * @param signature IDA-style byte array pattern, ie "48 8B ?? 24 38"
+         * @param kind Kind of section the signature lives in
+         * @return false if the signature is malformed, empty or longer than `N` bytes
+         */
+        constexpr bool assign(const char* signature, Section kind = Section::Any) {
+            text = signature;
+            section = kind;
+            size = 0;
+            for (const char* current = signature; *current != '\0'; ) {
+                if (isSeparator(*current)) {
+                    current++;
+                    continue;
+                }
+                if (size == N) {
+                    size = 0;
+                    return false;
+                }
+                if (*current == '?') {
+                    current += current[1] == '?' ? 2 : 1;
+                    bytes[size] = 0x00;
+                    mask[size] = 0x00;
+                }
+                else {
+                    int high = hexDigit(current[0]);
+                    int low = high < 0 ? -1 : hexDigit(current[1]);
+                    if (low < 0) {
+                        size = 0;
+                        return false;
+                    }
+                    bytes[size] = (uint8_t)((high << 4) | low);
+                    mask[size] = 0xFF;
+                    current += 2;
+                }
+                size++;
+                if (*current != '\0' && !isSeparator(*current)) {
+                    size = 0;
+                    return false;
+                }
+            }
+
+            // Rarest fixed byte is the primary anchor, second rarest the secondary one
+            wildcardOnly = true;
+            anchor = 0;
+            for (size_t i = 0; i < size; ++i) {
+                if (mask[i] != 0xFF) {
+                    continue;
+                }
+                if (wildcardOnly || byteRarity[bytes[i]] < byteRarity[bytes[anchor]]) {
+                    anchor = i;
+                }
+                wildcardOnly = false;
+            }
+            anchor2 = anchor;
+            bool second = false;
+            for (size_t i = 0; i < size; ++i) {
+                if (mask[i] != 0xFF || i == anchor) {
+                    continue;
+                }
+                if (!second || byteRarity[bytes[i]] < byteRarity[bytes[anchor2]]) {
+                    anchor2 = i;
+                    second = true;
+                }
+            }
+            return size > 0;
+        }
+
+        /**
+         * @brief View of the signature for the scanner
+         *
+         */
+        constexpr Pattern pattern() const {
+            return { text, bytes, mask, size, anchor, anchor2, wildcardOnly, section };
+        }
+    };
+
+    /**
+     * @brief Signature large enough for any signature parsed at runtime
+     *
+     */
+    typedef Signature<256> RuntimeSignature;
+
+    /**
+     * @brief Parse an IDA-style signature at runtime
+     * @details A malformed signature results in an empty one that never matches.
+     *
+     * @param signature IDA-style byte array pattern, ie "48 8B ?? 24 38"
+     * @param section Kind of section the signature lives in
+     * @return RuntimeSignature
+     */
+    RuntimeSignature parse(const char* signature, Section section = Section::Any);
+
+    /**
+     * @brief Check if a pattern matches at a given position
+     * @details The caller must make sure that `pattern.size` bytes are readable at `data`.
+     *
+     * @param data Position to check
+     * @param pattern Signature to look for
+     * @return true if every fixed byte of the pattern matches
+     */
+    bool match(const uint8_t* data, const Pattern& pattern);
+
+    /**
+     * @brief Get the fastest engine supported by the running CPU
+     *
+     * @return Engine
+     */
+    Engine bestEngine();
+
+    /**
+     * @brief Scan a range of memory for a pattern
+     * @details Every position in `data` where `pattern` matches is appended to `address` in
+     *      ascending order. The vectorized engines look for both anchor bytes 16 or 32 positions
+     *      at a time and only verify the full pattern on positions where both anchors match.
+     *
+     * @param data Start of the memory range
+     * @param size Size of the memory range in bytes
+     * @param pattern Signature to look for
+     * @param address Vector of addresses where the pattern was found
+     * @param engine Engine to use, `Engine::Auto` picks the fastest available
+     */
+    void scan(const uint8_t* data, size_t size, const Pattern& pattern, std::vector<uint64_t>* address, Engine engine = Engine::Auto);
+
+    /**
+     * @brief Scan a range of memory for several patterns in a single pass
+     * @details Patterns are grouped into buckets by the value of their primary anchor byte. The
+     *      range is walked once, each 16 or 32 byte block is loaded a single time and compared
+     *      against every bucket, and candidates are verified against the patterns in the bucket
+     *      that matched. `addresses` is resized to `patterns.size()` and `(*addresses)[i]` holds
+     *      the hits of `patterns[i]` in ascending order, identical to what `scan` would return
+     *      for that pattern alone.
+     *
+     * @param data Start of the memory range
+     * @param size Size of the memory range in bytes
+     * @param patterns Parsed signatures
+     * @param addresses Per pattern vector of addresses where the pattern was found
+     * @param engine Engine to use, `Engine::Auto` picks the fastest available
+     */
+    void scanBatch(const uint8_t* data, size_t size, const std::vector<const Pattern*>& patterns, std::vector<std::vector<uint64_t>>* addresses, Engine engine = Engine::Auto);
+
+    /**
+     * @brief Scan a range of memory for several patterns using multiple threads
+     * @details Same results as `scanBatch`, in the same order. The range is split into chunks
+     *      that are handed out to a group of worker threads, each chunk is scanned past its end
+     *      by the length of the longest pattern so hits straddling two chunks are still found,
+     *      and a hit is only kept by the chunk it starts in. Hits are merged in chunk order so
+     *      the first hit of every pattern is always the lowest address. Ranges too small to be
+     *      worth splitting are scanned on the calling thread.
+     *
+     * @param data Start of the memory range
+     * @param size Size of the memory range in bytes
+     * @param patterns Parsed signatures
+     * @param addresses Per pattern vector of addresses where the pattern was found
+     * @param threads Number of threads to use including the calling one, 0 picks one per core
+     * @param engine Engine to use, `Engine::Auto` picks the fastest available
+     */
+    void scanBatchParallel(const uint8_t* data, size_t size, const std::vector<const Pattern*>& patterns, std::vector<std::vector<uint64_t>>* addresses, size_t threads = 0, Engine engine = Engine::Auto);
+}
@@ -0,0 +1,57 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include "scanner.hpp"
+
+/**
+ * @brief Signatures of every fix.
+ * @details All of these are scanned for together in a single pass over the game DLL by
+ * `scanSignatures` as soon as it loads, `resolveFixes` then applies each fix at the hits that
+ * batch scan returned for its signatures.
+ * They live in their own header so the benchmark scans for exactly what the fix does.
+ *
+ * A signature ending in `Fallback` is tried by its fix when the signature before it has no unique
+ * hit. They wildcard what a game update is likely to move around, ie stack offsets, but keep
+ * every byte the hook depends on, and are only used when they have a single hit.
+ *
+ */
+namespace Signatures {
+    using Scanner::Signature;
+    using Scanner::Section;
+    constexpr Signature centerUi              ("C7 87 ?? ?? ?? ?? ?? ?? ?? ??    F3 41 0F 5C C1", Section::Code);
+    constexpr Signature aspectRatio           ("39 8E E3 3F", Section::Data);
+    constexpr Signature viewport              ("41 D1 F8    41 8B C0    C1 E8 1F", Section::Code);
+    constexpr Signature viewportFallback      ("41 D1 F8    41 8B C0", Section::Code);
+    constexpr Signature textBubblePlacement0  ("F3 0F 5E 4B 04    48 89 47 04", Section::Code);
+    constexpr Signature textBubblePlacement1  ("F3 41 0F 10 48 08    0F C6 C0 00", Section::Code);
+    constexpr Signature combatOverlay         ("8B 82 80 02 00 00    4C 8D 89 E0 00 00 00", Section::Code);
+    constexpr Signature uiElements            ("48 8B 74 24 38    48 8B 5C 24 40    48 83 C4 20    5F    C3    48 8D 81 88 03 00 00", Section::Code);
+    constexpr Signature uiElementsFallback    ("48 8B 74 24 ??    48 8B 5C 24 ??    48 83 C4 ??    5F    C3    48 8D 81 88 03 00 00", Section::Code);
+    constexpr Signature cutscene              ("0F 28 CA    F3 0F 59 89 A4 03 00 00", Section::Code);
+    constexpr Signature constrainAntiAliasing ("44 0F BE 4A 10    44 0F BE 52 11", Section::Code);
+}
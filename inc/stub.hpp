@@ -0,0 +1,213 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <vector>
+#include <initializer_list>
+#include <span>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+#include "Zydis/Zydis.h"
+#include "safetyhook.hpp"
+
+namespace Stub
+{
+    /**
+     * @brief Minimal x86_64 assembler on top of the Zydis encoder.
+     * @details Only what hand written hook stubs need, instructions are encoded one by one into a
+     *      byte buffer and forward branches are resolved through fixups. If any instruction fails
+     *      to encode the assembler is marked as failed and `ok` returns false.
+     */
+    class Assembler {
+    public:
+        /**
+         * @brief Encode a single instruction
+         *
+         * @param mnemonic Instruction mnemonic, ie `ZYDIS_MNEMONIC_MOV`
+         * @param operands Operands built with `reg`, `imm` and `mem`
+         */
+        void emit(ZydisMnemonic mnemonic, std::initializer_list<ZydisEncoderOperand> operands);
+
+        /**
+         * @brief Encode a forward near branch with a 32 bit displacement to be bound later
+         *
+         * @param mnemonic Branch mnemonic, ie `ZYDIS_MNEMONIC_JZ` or `ZYDIS_MNEMONIC_JMP`
+         * @return Fixup to give to `bind`
+         */
+        size_t jump(ZydisMnemonic mnemonic);
+
+        /**
+         * @brief Point a branch created by `jump` at the current position
+         *
+         * @param fixup Fixup returned by `jump`
+         */
+        void bind(size_t fixup);
+
+        /**
+         * @brief Encode `jmp qword [rip+0]` followed by the absolute target
+         *
+         * @param target Absolute address to jump to
+         * @return Offset of the 8 byte target in the buffer so it can be filled in later
+         */
+        size_t jumpAbsolute(uintptr_t target);
+
+        bool ok() const { return m_ok; }
+        const std::vector<uint8_t>& code() const { return m_code; }
+
+    private:
+        std::vector<uint8_t> m_code;
+        bool m_ok = true;
+    };
+
+    /**
+     * @brief Register operand
+     *
+     */
+    ZydisEncoderOperand reg(ZydisRegister value);
+
+    /**
+     * @brief Immediate operand
+     *
+     */
+    ZydisEncoderOperand imm(int64_t value);
+
+    /**
+     * @brief Memory operand of the form `[base+displacement]`
+     *
+     * @param base Base register
+     * @param displacement Displacement from the base register
+     * @param size Size of the access in bytes
+     */
+    ZydisEncoderOperand mem(ZydisRegister base, int64_t displacement, uint16_t size);
+
+    /**
+     * @brief Function that emits the body of a stub.
+     * @details The body runs in place of the hooked instructions with the exact register state of
+     *      the game at the hook location. It must preserve every register and flag it touches,
+     *      a jump to the displaced original instructions is appended after it.
+     */
+    typedef void (*emitter_t)(Assembler& a);
+
+    /**
+     * @brief Hook a location with a hand assembled stub
+     * @details The stub is written into executable memory taken from `allocator` close to `target`, then an
+     *      inline hook redirects `target` to it. The inline hook is created disabled and only
+     *      enabled once the stub has been linked to its trampoline, so the game never runs a
+     *      half built stub. Unlike a mid hook no context is captured, the stub only pays for the
+     *      registers it saves itself.
+     *
+     * @param allocator Arena the stub and the trampoline are allocated from, ie `Hooks::arena`
+     * @param target Location to hook
+     * @param emitter Emits the body of the stub
+     * @param hook Receives the inline hook on success
+     * @param code Receives the stub memory on success, must outlive `hook`
+     * @return true on success
+     */
+    bool create(
+        const std::shared_ptr<safetyhook::Allocator>& allocator,
+        void* target,
+        emitter_t emitter,
+        SafetyHookInline* hook,
+        safetyhook::Allocation* code
+    );
+
+    /**
+     * @brief Kind of test of a `guard_t`.
+     *
+     */
+    enum class Test {
+        RegisterEquals,
+        Memory32Equals,
+        ByteSet,
+    };
+
+    /**
+     * @brief A condition a mid hook callback only acts on when it holds.
+     * @details `RegisterEquals` compares the full register against `value`, `Memory32Equals`
+     *      compares the 4 bytes at `[reg+displacement]` against the low 32 bits of `value`.
+     *      `value` is sign extended from 32 bits as that is all `cmp` can encode. `ByteSet` holds
+     *      when the byte at the absolute `address` is not 0, ie a `Callbacks::toggles_t` switch.
+     */
+    typedef struct guard_t {
+        Test test;
+        ZydisRegister reg;
+        int32_t displacement;
+        int32_t value;
+        const void* address;
+    } guard_t;
+
+    constexpr guard_t registerEquals(ZydisRegister reg, int32_t value) {
+        return { Test::RegisterEquals, reg, 0, value, nullptr };
+    }
+
+    constexpr guard_t memory32Equals(ZydisRegister reg, int32_t displacement, uint32_t value) {
+        return { Test::Memory32Equals, reg, displacement, (int32_t)value, nullptr };
+    }
+
+    constexpr guard_t byteSet(const void* address) {
+        return { Test::ByteSet, ZYDIS_REGISTER_NONE, 0, 0, address };
+    }
+
+    /**
+     * @brief Compares the float at `[reg+displacement]` bit for bit against `value`
+     * @details Unlike `==` on floats this does not match `-0.0f` against `0.0f`, `value` must
+     *      not be zero or the callback may be skipped for calls it would have acted on.
+     */
+    constexpr guard_t floatEquals(ZydisRegister reg, int32_t displacement, float value) {
+        return memory32Equals(reg, displacement, std::bit_cast<uint32_t>(value));
+    }
+
+    /**
+     * @brief Hook a location with a mid hook that only runs when all guards hold
+     * @details A stub tests the guards in order on the game's registers and jumps straight back
+     *      into the game on the first one that fails, only when all of them hold does it enter a
+     *      mid hook running `callback`. The context is then only captured for calls the callback
+     *      acts on. Memory guards must be preceded by a guard ensuring their register is a valid
+     *      pointer. The guards of a callback must be implied by its own condition, the callback
+     *      still runs its full check.
+     *
+     * @param allocator Arena the stub, the mid hook and the trampoline are allocated from
+     * @param target Location to hook
+     * @param guards Guards to test, all of them must hold
+     * @param callback Mid hook callback
+     * @param hook Receives the inline hook on success
+     * @param midHook Receives the mid hook running `callback` on success, must outlive `hook`
+     * @param code Receives the stub memory on success, must outlive `midHook`
+     * @return true on success
+     */
+    bool createGuarded(
+        const std::shared_ptr<safetyhook::Allocator>& allocator,
+        void* target,
+        std::span<const guard_t> guards,
+        safetyhook::MidHookFn callback,
+        SafetyHookInline* hook,
+        SafetyMidHook* midHook,
+        safetyhook::Allocation* code
+    );
+}
@@ -0,0 +1,85 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <windows.h>
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Per frame telemetry, only built with the `HOOK_TELEMETRY` CMake option.
+ * @details The game's present call is hooked and every frame is recorded into a preallocated
+ *      ring, the present hook never allocates, locks or touches the disk. A background thread
+ *      drains the ring into a CSV file and, with `HOOK_TELEMETRY_OVERLAY`, shows a summary of
+ *      the last interval in a small window on top of the game.
+ */
+namespace Telemetry
+{
+    constexpr size_t RING_SIZE = 4096;
+    constexpr uint32_t NO_MODULE = UINT8_MAX;
+
+    /**
+     * @brief A single recorded frame.
+     * @details `hookCycles` is the total of all hook calls since startup as counted by `Metrics`,
+     *      it stays 0 without `HOOK_METRICS`. `fixes` has bit n set when the n-th switch of
+     *      `Callbacks::toggles_t` is on. `module` is an index into the names given to `start`.
+     */
+    typedef struct frame_t {
+        int64_t qpc;
+        uint64_t hookCycles;
+        uint32_t fixes;
+        uint16_t width;
+        uint16_t height;
+        uint32_t module;
+    } frame_t;
+
+    /**
+     * @brief Hook the present call and start writing frames to a CSV file
+     * @details A throwaway D3D11 device and swap chain are created to find the present call, all
+     *      swap chains share it. Must not be called from `DllMain`.
+     *
+     * @param path Path of the CSV file, it is overwritten
+     * @param modules Names of the game DLL's, ie `gameDllTable`
+     * @param intervalMs Milliseconds between writes to the CSV file
+     * @return true if the present call was hooked
+     */
+    bool start(const std::string& path, const std::vector<std::string>& modules, uint32_t intervalMs);
+
+    /**
+     * @brief Set the game DLL recorded with every following frame
+     *
+     * @param module Index into the names given to `start`, or `NO_MODULE`
+     */
+    void setModule(uint32_t module);
+
+    /**
+     * @brief Set the resolution recorded with every following frame
+     *
+     */
+    void setResolution(int width, int height);
+}
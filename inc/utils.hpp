@@ -27,9 +27,36 @@
 #include <windows.h>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "scanner.hpp"
 
 namespace Utils
 {
+    constexpr size_t MAX_HEX_BYTES = 64;
+
+    /**
+     * @brief Hex text of up to `MAX_HEX_BYTES` bytes, held in place so making one never allocates.
+     *
+     */
+    typedef struct hexString_t {
+        char text[MAX_HEX_BYTES * 3];
+        size_t size;
+
+        std::string_view view() const { return { text, size }; }
+    } hexString_t;
+
+    /**
+     * @brief A readable range of a mapped module.
+     *
+     */
+    typedef struct region_t {
+        uint8_t* data;
+        size_t size;
+        Scanner::Section section;
+    } region_t;
+
     /**
      * @brief Retrieves information about the compiler being used.
      * @details This function returns a string containing the name and version of the
@@ -47,32 +74,52 @@ namespace Utils
 
     /**
      * @brief Convert memory bytes into string representation
-     * @details Converts the bytes pointed to by the `bytes` parameter into a string.
+     * @details Converts the bytes pointed to by the `bytes` parameter into hex text for logging.
      *      The total number of bytes that will be converted is based on the `size`
-     *      parameter. The returned string will be in hexidecimal format and will be
-     *      organized as the bytes appear in memory. For example, if the `bytes` parameter
+     *      parameter, at most `MAX_HEX_BYTES` are converted and the rest is cut off. The text
+     *      will be organized as the bytes appear in memory. For example, if the `bytes` parameter
      *      points to some integer in memory equal to `0x12345678`, and the `size` parameter
-     *      is given sizeof(int), then the returned string shall be "78 56 34 12", as that is
-     *      how `0x12345678` is stored in memory, on little endian x86_64.
+     *      is given sizeof(int), then the text shall be "78 56 34 12", as that is
+     *      how `0x12345678` is stored in memory, on little endian x86_64. The text is formatted
+     *      into the returned value, nothing is allocated.
      *
      * @param bytes Pointer to memory
      * @param size Size of `bytes` parameter
-     * @return std::string
+     * @return hexString_t
      *
      * @code
      * float a = 3.5555556; // In hex: 0x40638E39
-     * std::string string = bytesToString(&a, sizeof(float));
-     * std::cout << string << std::endl; // Prints "39 8E 63 40"
+     * Utils::hexString_t string = bytesToString(&a, sizeof(float));
+     * std::cout << string.view() << std::endl; // Prints "39 8E 63 40"
      * @endcode
      */
-    std::string bytesToString(void* bytes, size_t size);
+    hexString_t bytesToString(const void* bytes, size_t size);
+
+    /**
+     * @brief Patch an area of memory with raw bytes
+     * @details Makes the range writable, copies `size` bytes from `bytes` over it, restores the
+     *      protection and flushes the instruction cache. Nothing is parsed or allocated. Use a
+     *      `Patch::Transaction` instead when several areas are patched together.
+     *
+     * @param address Starting memory address
+     * @param bytes Bytes to write
+     * @param size Number of bytes to write
+     */
+    void patch(uintptr_t address, const void* bytes, size_t size);
 
     /**
-     * @brief Get the width and height, respectively, of the desktop in pixels
+     * @brief Patch an area of memory with the bytes of a value
+     * @details `Utils::patch<float>(address, aspectRatio);` writes the 4 bytes of the float as
+     *      they are in memory, without going through text.
      *
-     * @return std::pair<int, int>
+     * @param address Starting memory address
+     * @param value Value to write
      */
-    std::pair<int, int> GetDesktopDimensions();
+    template <typename T>
+        requires (std::is_trivially_copyable_v<T> && !std::is_pointer_v<T> && !std::is_array_v<T>)
+    void patch(uintptr_t address, const T& value) {
+        patch(address, &value, sizeof(T));
+    }
 
     /**
      * @brief Patch an area of memory with a pattern
@@ -84,23 +131,71 @@ namespace Utils
      *      be patched is determined by the size of the `pattern` parameter. If the example
      *      hex string above is referenced then the total amount of memory that will be
      *      patched is 4 bytes, starting at the address[0] and ending at the address[3].
+     *      The pattern is parsed into a stack buffer, prefer the raw or typed `patch`, or
+     *      `Patch::Bytes` for patterns known at compile time, so there is nothing to parse.
      *
      * @param address Starting memory address
      * @param pattern IDA-style byte array pattern
      */
     void patch(uintptr_t address, const char* pattern);
 
+    /**
+     * @brief Get the readable regions of a mapped module split by section kind
+     * @details Walks the `IMAGE_SECTION_HEADER`s of the module, executable sections are of kind
+     *      `Scanner::Section::Code`, initialized data sections such as `.rdata` and `.data` are
+     *      of kind `Scanner::Section::Data`, and the headers and anything else such as `.pdata`,
+     *      `.rsrc` or `.reloc` are of kind `Scanner::Section::Any`. Every section is further
+     *      split with `VirtualQuery` so that only committed pages which are not guard or no
+     *      access pages are returned. Regions are returned in ascending address order.
+     *
+     * @param module Base of the module
+     * @return std::vector<region_t>
+     */
+    std::vector<region_t> getModuleRegions(void* module);
+
+    /**
+     * @brief Check if a byte pattern matches at a relative address of a module
+     * @details Used to confirm a previously found address without scanning. The check fails if
+     *      the pattern would run past the end of any readable region of the module.
+     *
+     * @param module Base of the module
+     * @param rva Address relative to the module base
+     * @param pattern Signature to check
+     * @return true if the pattern matches at `module + rva`
+     */
+    bool patternMatch(void* module, uint32_t rva, const Scanner::Pattern& pattern);
+
     /**
      * @brief Scan for a given byte pattern on a module
-     * @details Obtained and modified from:
+     * @details Originally obtained and modified from:
      *      https://github.com/OneshotGH/CSGOSimple-master/blob/master/CSGOSimple/helpers/utils.cpp
-     *      Original implementation is for the most part intact. Modified so that all
-     *      the addresses where the pattern is found is appended to the `address` vector,
-     *      instead of returning the address when the first instance is found.
+     *      The search itself is now done by `Scanner::scan` which uses SSE2 or AVX2, whichever
+     *      the CPU supports, to find candidates before verifying them. All the addresses where
+     *      the pattern is found are appended to the `address` vector, instead of returning the
+     *      address when the first instance is found. Only the regions returned by
+     *      `getModuleRegions` are scanned, so uncommitted and guard pages are never touched, and
+     *      of those only the ones that match the section hint of the signature. Signatures are
+     *      parsed ahead of time into a `Scanner::Signature`, usually at compile time, so nothing is
+     *      parsed or allocated here.
      *
      * @param module Base of the module to search
-     * @param signature IDA-style byte array pattern
+     * @param pattern Signature to look for
      * @param address Vector of addresses where the pattern was found
      */
-    void patternScan(void* module, const char* signature, std::vector<uint64_t>* address);
+    void patternScan(void* module, const Scanner::Pattern& pattern, std::vector<uint64_t>* address);
+
+    /**
+     * @brief Scan for several byte patterns on a module in a single pass
+     * @details Same as the single signature `patternScan` but all signatures are searched for
+     *      together by `Scanner::scanBatchParallel`, so the module is only walked once no matter
+     *      how many signatures are given and large sections are split over several threads.
+     *      Each signature is only searched for in the regions that match its section hint, ie
+     *      code signatures only in executable sections. The `(*address)[i]` vector holds the
+     *      hits of `patterns[i]` in ascending order.
+     *
+     * @param module Base of the module to search
+     * @param patterns Signatures to look for
+     * @param address Per signature vector of addresses where the pattern was found
+     */
+    void patternScan(void* module, const std::vector<Scanner::Pattern>& patterns, std::vector<std::vector<uint64_t>>* address);
 }
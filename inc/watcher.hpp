@@ -0,0 +1,142 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <windows.h>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace Watcher
+{
+    /**
+     * @brief Reason a watched module event was raised.
+     *
+     */
+    enum class Reason {
+        Loaded,
+        Unloaded,
+        Notified,
+    };
+
+    /**
+     * @brief A single load or unload of one of the watched modules, or a `notify`.
+     * @details `module` is NULL and `index` is SIZE_MAX for `Reason::Notified` events.
+     *
+     */
+    typedef struct event_t {
+        Reason reason;
+        HMODULE module;
+        size_t index;
+        uint32_t sequence;
+    } event_t;
+
+    /**
+     * @brief Called for a watched module as soon as it is mapped.
+     * @details `mapping` is true when called from the loader notification, the module is then
+     *      mapped but none of its initializers have run yet. It is false for modules that were
+     *      already loaded when `init` was called. Runs inside the loader lock, it must not wait
+     *      on other threads or load libraries, and it delays the load of the module.
+     */
+    typedef void (*mapped_t)(HMODULE module, size_t index, bool mapping);
+
+    /**
+     * @brief Start watching for the given modules to map and unmap.
+     * @details Registers a loader DLL notification with ntdll so the loader itself tells us when
+     *      a module is mapped into or unmapped from the process. The notification callback runs
+     *      inside the loader lock so it does nothing more than compare the module name against
+     *      the watch list and queue an event. Any module from the list that is already loaded at
+     *      the time of the call is queued as a `Reason::Loaded` event so nothing is missed.
+     *      `mapped` is called right before a `Reason::Loaded` event is queued.
+     *
+     * @param modules Names of the modules to watch, ie "hackGU_vol1.dll"
+     * @param mapped Optional callback for work that has to be done before the module initializes
+     * @return true if the notification was registered, false otherwise
+     */
+    bool init(const std::vector<std::string>& modules, mapped_t mapped = nullptr);
+
+    /**
+     * @brief Block until the next watched module event arrives.
+     * @details The calling thread sleeps on a semaphore and consumes no CPU time while waiting.
+     *      Events are returned in the order the loader raised them. The `index` member of the
+     *      returned event indexes into the `modules` vector given to `init`.
+     *
+     * Every `Reason::Unloaded` event must be `claim`ed before touching the module and handed back
+     * to `release` once the caller is done with it, see `release` for why.
+     *
+     * @return event_t
+     */
+    event_t wait();
+
+    /**
+     * @brief Let the loader finish unloading the module of an `Reason::Unloaded` event.
+     * @details The loader raises the unload notification before it unmaps the module. The
+     *      notification callback holds the loader there until the event is released, which gives
+     *      the caller a window where the module is going away but its memory is still mapped and
+     *      nothing else can be mapped at its address. Hooks into the module can be safely torn
+     *      down in that window. The loader is let go on its own after `RELEASE_TIMEOUT` ms so a
+     *      caller that never releases cannot hang the game, unless the event was claimed in time.
+     *
+     * @param event Event returned by `wait`
+     */
+    void release(const event_t& event);
+
+    /**
+     * @brief Claim the window of an `Reason::Unloaded` event before touching its module.
+     * @details Once claimed the loader waits for `release` without a timeout, so the module stays
+     *      mapped for as long as the caller needs. If `RELEASE_TIMEOUT` ran out before the claim
+     *      the loader has already moved on and the module may be unmapped, nothing in it may be
+     *      written to then. The event must still be handed to `release`.
+     *
+     * @param event Event returned by `wait`
+     * @return true if the module is held mapped until `release`, false if the loader gave up
+     */
+    bool claim(const event_t& event);
+
+    /**
+     * @brief Queue a `Reason::Notified` event to wake up the thread sitting in `wait`.
+     * @details A notification that is still queued is not queued again, so several calls in a
+     *      row before `wait` picks them up are seen as one.
+     *
+     * @return void
+     */
+    void notify();
+
+    /**
+     * @brief Call `notify` every time a file is written to.
+     * @details Starts a thread that sleeps on `ReadDirectoryChangesW` for the directory of the file,
+     *      so nothing is polled. Editors tend to write a file in several steps, a change is only
+     *      notified once the file has been left alone for `SETTLE_TIME` ms. Only one file can be
+     *      watched.
+     *
+     * @param path Path of the file, relative paths are resolved against the working directory
+     * @return true if the watch thread was started, false otherwise
+     */
+    bool watchFile(const std::string& path);
+
+    constexpr DWORD RELEASE_TIMEOUT = 1000;
+    constexpr DWORD SETTLE_TIME = 200;
+}
@@ -41,7 +41,7 @@ $scriptsFolder = "scripts"
 $fullPath = "$gameFolder\$gameSubFolder\$scriptsFolder"
 
 $fixName = "HackGULastRecodeFix"
-$pyPatch = "HackGULastRecodePatch.py"
+$patcherName = "HackGULastRecodePatch"
 
 $ymlFileContent = @"
 name: Hack GU Last Recode Fix
@@ -49,11 +49,25 @@ name: Hack GU Last Recode Fix
 # Enables or disables this mod
 masterEnable: true
 
+# Logging to HackGULastRecodeFix.log
+# level: Messages below this level are not logged (trace, debug, info, warn, err, critical, off)
+# flushLevel: Messages at or above this level are written to disk right away
+# flushInterval: Seconds between writing everything else to disk, 0 to never do so
+#                switching to 0 while the game runs only takes effect on the next start
+log:
+  level: info
+  flushLevel: warn
+  flushInterval: 3
+
 # Enter desired resolution.
-# A value of 0 in either width or height will use your desktop's resolution.
+# A value of 0 in either width or height will use the resolution of a monitor.
+# monitor picks that monitor, 1 is the primary monitor and the others follow from left to right.
+# A monitor of 0 uses the monitor the game window is on, the patcher uses the primary monitor then,
+# so set it when the game runs on another monitor.
 resolution:
   width: 0
   height: 0
+  monitor: 0
 
 # Available features
 features:
@@ -62,6 +76,16 @@ features:
   # If disabled combat will not render gray tint overlay
   combatOverlay:
     enable: true
+
+# Switch single fixes on or off, takes effect right away while the game is running
+fixes:
+  centerUi: true
+  viewport: true
+  textBubblePlacement: true
+  combatOverlay: true
+  uiElements: true
+  cutscene: true
+  constrainAntiAliasing: true
 "@
 
 if (Test-Path -Path $gameFolder) {
@@ -71,10 +95,9 @@ if (Test-Path -Path $gameFolder) {
     Write-Output "Copying DLL to $fullPath"
     Copy-Item -Path $dllPath -Destination "$fullPath"
     Move-Item -Path $fullPath\$fixName.dll -Destination $fullPath\$fixName.asi -Force
-    Write-Output "Copying $pyPatch to $fullPath"
-    Copy-Item -Path $PSScriptRoot\$pyPatch -Destination "$fullPath"
-    Write-Host "Running PyInstaller..."
-    pyinstaller --specpath $fullPath --distpath $fullPath --onefile $fullPath\$pyPatch
+    $patcherPath = Get-ChildItem -Path "$PSScriptRoot\bin" -Filter "$patcherName.exe" -Recurse
+    Write-Output "Copying $patcherPath to $fullPath"
+    Copy-Item -Path $patcherPath -Destination "$fullPath"
     Write-Output "Creating $fixName.yml at $fullPath"
     New-Item -Path $fullPath -Name "$fixName.yml" -ItemType File -Value $ymlFileContent -Force | Out-Null
     Write-Output "Done!"
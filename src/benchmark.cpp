@@ -0,0 +1,428 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/**
+ * @file benchmark.cpp
+ * @brief Hack GU Last Recode scanner and patcher benchmark
+ *
+ * @details
+ * Runs every signature the fix and the patcher look for through every scan engine and every way
+ * of scanning, single pattern, batch and parallel batch, over captured game DLL images or
+ * synthetic images of the same size. For each run the best time of all repeats, the time per
+ * byte and the number of heap allocations made by a single run are reported. The hits of every
+ * run are compared against the plain scalar single pattern scan and any difference fails the
+ * benchmark, so a change to the scanner has to be both faster and still find the same hits.
+ *
+ * Byte patching is measured as well, one `Utils::patch` per edit, from text and typed, against
+ * a single `Patch::Transaction` holding all of them, together with `Utils::bytesToString`.
+ *
+ * Usage:
+ *   HackGULastRecodeBench [--repeat N] [--threads N] [--synthetic MB] [path...]
+ *
+ *   A path is either a game DLL or a folder, every hackGU_*.dll in a folder is benchmarked. The
+ *   files are read as they are on disk which is close enough to the mapped image for timing. If
+ *   no path is given a synthetic image of `--synthetic` MB is generated instead.
+ */
+
+// System includes
+#include <windows.h>
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <format>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+
+// Local includes
+#include "utils.hpp"
+#include "scanner.hpp"
+#include "patch.hpp"
+#include "resolution.hpp"
+#include "signatures.hpp"
+
+// Macros
+#define LOG(STRING, ...) std::cout << std::format(STRING "\n", ##__VA_ARGS__)
+
+namespace
+{
+    // Every heap allocation of the process, counted by the replaced global operator new below
+    std::atomic<uint64_t> allocations = 0;
+}
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void* memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+/**
+ * @brief An image to scan.
+ *
+ */
+typedef struct image_t {
+    std::string name;
+    std::vector<uint8_t> data;
+} image_t;
+
+/**
+ * @brief Timing of a single benchmark run.
+ *
+ */
+typedef struct measurement_t {
+    double seconds;
+    uint64_t allocations;
+} measurement_t;
+
+typedef std::vector<std::vector<uint64_t>> hits_t;
+
+/**
+ * @brief Every signature that is scanned for in production.
+ *
+ */
+const std::vector<Scanner::Pattern> patternTable = {
+    Signatures::centerUi.pattern(),
+    Signatures::aspectRatio.pattern(),
+    Signatures::viewport.pattern(),
+    Signatures::viewportFallback.pattern(),
+    Signatures::textBubblePlacement0.pattern(),
+    Signatures::textBubblePlacement1.pattern(),
+    Signatures::combatOverlay.pattern(),
+    Signatures::uiElements.pattern(),
+    Signatures::uiElementsFallback.pattern(),
+    Signatures::cutscene.pattern(),
+    Signatures::constrainAntiAliasing.pattern(),
+    Resolution::originalTable.pattern(),
+};
+
+/**
+ * @brief Runs a benchmark several times and keeps the fastest run.
+ *
+ * @param repeat Number of runs
+ * @param run Benchmark to run
+ * @return measurement_t Time of the fastest run and allocations of a single run
+ */
+template<typename F>
+measurement_t measure(size_t repeat, F&& run) {
+    measurement_t best = { 1e30, 0 };
+    for (size_t i = 0; i < repeat; ++i) {
+        uint64_t before = allocations.load(std::memory_order_relaxed);
+        auto begin = std::chrono::steady_clock::now();
+        run();
+        auto end = std::chrono::steady_clock::now();
+        best.allocations = allocations.load(std::memory_order_relaxed) - before;
+        best.seconds = (std::min)(best.seconds, std::chrono::duration<double>(end - begin).count());
+    }
+    return best;
+}
+
+/**
+ * @brief Reads an image from disk.
+ *
+ * @param path Path of the image
+ * @param image Image to read into
+ * @return true if the image was read, false otherwise
+ */
+bool loadImage(const std::filesystem::path& path, image_t* image) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    image->name = path.filename().string();
+    image->data.resize((size_t)file.tellg());
+    file.seekg(0);
+    return (bool)file.read(reinterpret_cast<char*>(image->data.data()), image->data.size());
+}
+
+/**
+ * @brief Generates an image that looks roughly like x86_64 code and data.
+ * @details Bytes are drawn from `Scanner::commonBytes` most of the time so the scanners see
+ * a realistic number of anchor candidates. Every signature is planted a few times with random
+ * bytes in its wildcards so there are hits to compare.
+ *
+ * @param size Size of the image in bytes
+ * @return image_t
+ */
+image_t syntheticImage(size_t size) {
+    image_t image = { std::format("synthetic {} MB", size >> 20), std::vector<uint8_t>(size) };
+    std::mt19937 random(0x4C617374);
+    std::uniform_int_distribution<uint32_t> byte(0, 255);
+    std::uniform_int_distribution<size_t> common(0, sizeof(Scanner::commonBytes) - 1);
+    for (auto& value : image.data) {
+        value = (byte(random) < 180) ? Scanner::commonBytes[common(random)] : (uint8_t)byte(random);
+    }
+    for (const auto& pattern : patternTable) {
+        std::uniform_int_distribution<size_t> offset(0, size - pattern.size);
+        for (size_t i = 0; i < 4; ++i) {
+            uint8_t* at = image.data.data() + offset(random);
+            for (size_t j = 0; j < pattern.size; ++j) {
+                at[j] = pattern.bytes[j] | ((uint8_t)byte(random) & ~pattern.mask[j]);
+            }
+        }
+    }
+    return image;
+}
+
+/**
+ * @brief Gets the name of a scan engine.
+ *
+ * @param engine Engine
+ * @return const char*
+ */
+const char* engineName(Scanner::Engine engine) {
+    switch (engine) {
+    case Scanner::Engine::Scalar: return "scalar";
+    case Scanner::Engine::Sse2:   return "sse2";
+    case Scanner::Engine::Avx2:   return "avx2";
+    default:                      return "auto";
+    }
+}
+
+/**
+ * @brief Benchmarks every way of scanning with every engine over one image.
+ *
+ * @param image Image to scan
+ * @param repeat Number of runs of each benchmark
+ * @param threads Number of threads of the parallel scan, 0 for one per core
+ * @return true if every run found exactly the hits of the reference scan
+ */
+bool benchmarkScan(const image_t& image, size_t repeat, size_t threads) {
+    const uint8_t* data = image.data.data();
+    size_t size = image.data.size();
+    std::vector<const Scanner::Pattern*> patterns;
+    for (const auto& pattern : patternTable) {
+        patterns.push_back(&pattern);
+    }
+
+    // Reference hits every other run has to match
+    hits_t reference(patterns.size());
+    for (size_t i = 0; i < patterns.size(); ++i) {
+        Scanner::scan(data, size, *patterns[i], &reference[i], Scanner::Engine::Scalar);
+    }
+    size_t total = 0;
+    for (const auto& hits : reference) {
+        total += hits.size();
+    }
+    LOG("{}: {} bytes, {} signatures, {} hits", image.name, size, patterns.size(), total);
+
+    std::vector<Scanner::Engine> engines = { Scanner::Engine::Scalar, Scanner::Engine::Sse2 };
+    if (Scanner::bestEngine() == Scanner::Engine::Avx2) {
+        engines.push_back(Scanner::Engine::Avx2);
+    }
+
+    bool identical = true;
+    auto report = [&](const char* kind, Scanner::Engine engine, const measurement_t& measurement, const hits_t& hits) {
+        bool same = hits == reference;
+        identical = identical && same;
+        LOG("  {:<10} {:<8} {:>10.3f} ms {:>8.4f} ns/byte {:>6} allocs  {}",
+            kind,
+            engineName(engine),
+            measurement.seconds * 1e3,
+            measurement.seconds * 1e9 / (double)size,
+            measurement.allocations,
+            same ? "ok" : "MISMATCH"
+        );
+    };
+
+    for (auto engine : engines) {
+        hits_t hits;
+        measurement_t measurement = measure(repeat, [&]() {
+            hits.assign(patterns.size(), {});
+            for (size_t i = 0; i < patterns.size(); ++i) {
+                Scanner::scan(data, size, *patterns[i], &hits[i], engine);
+            }
+        });
+        report("single", engine, measurement, hits);
+    }
+    for (auto engine : engines) {
+        hits_t hits;
+        measurement_t measurement = measure(repeat, [&]() {
+            Scanner::scanBatch(data, size, patterns, &hits, engine);
+        });
+        report("batch", engine, measurement, hits);
+    }
+    for (auto engine : engines) {
+        hits_t hits;
+        measurement_t measurement = measure(repeat, [&]() {
+            Scanner::scanBatchParallel(data, size, patterns, &hits, threads, engine);
+        });
+        report("parallel", engine, measurement, hits);
+    }
+    return identical;
+}
+
+/**
+ * @brief Benchmarks patching scattered bytes of read only pages, one by one and as a transaction.
+ *
+ * @param repeat Number of runs of each benchmark
+ * @return true if both ways wrote the same bytes
+ */
+bool benchmarkPatch(size_t repeat) {
+    constexpr size_t PAGES = 256;
+    constexpr size_t EDITS = 1024;
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    size_t size = PAGES * info.dwPageSize;
+    uint8_t* oneByOne = (uint8_t*)VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    uint8_t* grouped = (uint8_t*)VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (oneByOne == nullptr || grouped == nullptr) {
+        LOG("Failed to allocate patch buffers");
+        return false;
+    }
+    DWORD oldProtect;
+    VirtualProtect(oneByOne, size, PAGE_EXECUTE_READ, &oldProtect);
+    VirtualProtect(grouped, size, PAGE_EXECUTE_READ, &oldProtect);
+
+    float value = 2.370370f;
+    Utils::hexString_t text;
+    measurement_t toString = measure(repeat, [&]() {
+        for (size_t i = 0; i < EDITS; ++i) {
+            text = Utils::bytesToString(&value, sizeof(value));
+        }
+    });
+    LOG("  {:<30} {:>8.1f} ns/call {:>6.2f} allocs/call", "bytesToString",
+        toString.seconds * 1e9 / EDITS, (double)toString.allocations / EDITS);
+
+    std::string pattern(text.view());
+    size_t stride = size / EDITS;
+    measurement_t patch = measure(repeat, [&]() {
+        for (size_t i = 0; i < EDITS; ++i) {
+            Utils::patch((uintptr_t)(oneByOne + i * stride), pattern.c_str());
+        }
+    });
+    LOG("  {:<30} {:>8.1f} ns/edit {:>6.2f} allocs/edit", "Utils::patch (text)",
+        patch.seconds * 1e9 / EDITS, (double)patch.allocations / EDITS);
+
+    measurement_t typed = measure(repeat, [&]() {
+        for (size_t i = 0; i < EDITS; ++i) {
+            Utils::patch<float>((uintptr_t)(oneByOne + i * stride), value);
+        }
+    });
+    LOG("  {:<30} {:>8.1f} ns/edit {:>6.2f} allocs/edit", "Utils::patch<float>",
+        typed.seconds * 1e9 / EDITS, (double)typed.allocations / EDITS);
+
+    measurement_t transaction = measure(repeat, [&]() {
+        Patch::Transaction edits;
+        for (size_t i = 0; i < EDITS; ++i) {
+            edits.add((uintptr_t)(grouped + i * stride), &value, sizeof(value));
+        }
+        edits.commit();
+    });
+    LOG("  {:<30} {:>8.1f} ns/edit {:>6.2f} allocs/edit", "Patch::Transaction",
+        transaction.seconds * 1e9 / EDITS, (double)transaction.allocations / EDITS);
+
+    bool same = memcmp(oneByOne, grouped, size) == 0;
+    LOG("  {:<30} {}", "Patched bytes", same ? "ok" : "MISMATCH");
+    VirtualFree(oneByOne, 0, MEM_RELEASE);
+    VirtualFree(grouped, 0, MEM_RELEASE);
+    return same;
+}
+
+/**
+ * @brief Entry point of the benchmark.
+ *
+ * @param argc Number of arguments
+ * @param argv Arguments, see the usage above
+ * @return 0 if every run found the same hits and wrote the same bytes, 1 otherwise
+ */
+int main(int argc, char** argv) {
+    size_t repeat = 5;
+    size_t threads = 0;
+    size_t synthetic = 48;
+    std::vector<std::filesystem::path> paths;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--repeat" && i + 1 < argc) {
+            repeat = (std::max<size_t>)(1, std::strtoull(argv[++i], nullptr, 10));
+        }
+        else if (argument == "--threads" && i + 1 < argc) {
+            threads = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--synthetic" && i + 1 < argc) {
+            synthetic = (std::max<size_t>)(1, std::strtoull(argv[++i], nullptr, 10));
+        }
+        else {
+            paths.push_back(argument);
+        }
+    }
+
+    std::vector<image_t> images;
+    for (const auto& path : paths) {
+        std::vector<std::filesystem::path> files;
+        if (std::filesystem::is_directory(path)) {
+            for (const auto& entry : std::filesystem::directory_iterator(path)) {
+                std::string name = entry.path().filename().string();
+                if (name.starts_with("hackGU_") && entry.path().extension() == ".dll") {
+                    files.push_back(entry.path());
+                }
+            }
+        }
+        else {
+            files.push_back(path);
+        }
+        for (const auto& file : files) {
+            image_t image;
+            if (loadImage(file, &image)) {
+                images.push_back(std::move(image));
+            }
+            else {
+                LOG("Failed to read {}", file.string());
+            }
+        }
+    }
+    if (images.empty()) {
+        images.push_back(syntheticImage(synthetic << 20));
+    }
+
+    LOG("Best engine: {}, best of {} runs", engineName(Scanner::bestEngine()), repeat);
+    bool identical = true;
+    for (const auto& image : images) {
+        identical = benchmarkScan(image, repeat, threads) && identical;
+    }
+    LOG("Patching");
+    identical = benchmarkPatch(repeat) && identical;
+
+    LOG("{}", identical ? "All results identical" : "Results differ between engines");
+    return identical ? 0 : 1;
+}
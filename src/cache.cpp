@@ -0,0 +1,155 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <windows.h>
+#include <fstream>
+#include <string>
+#include <map>
+#include <cstdint>
+
+#include "yaml-cpp/yaml.h"
+
+#include "cache.hpp"
+
+namespace
+{
+    typedef struct hit_t {
+        uint32_t rva;
+        uint32_t count;
+    } hit_t;
+
+    typedef struct entry_t {
+        Cache::identity_t identity;
+        std::map<std::string, hit_t> rvas;
+    } entry_t;
+
+    std::string cachePath;
+    std::map<std::string, entry_t> entries;
+
+    /**
+     * @brief Key of a signature in the cache
+     * @details The same bytes searched for in another section can have other hits, so the section
+     *      hint is part of the key, ie "code:41 D1 F8".
+     */
+    std::string key(const Scanner::Pattern& pattern) {
+        switch (pattern.section) {
+            case Scanner::Section::Code: return std::string("code:") + pattern.text;
+            case Scanner::Section::Data: return std::string("data:") + pattern.text;
+            default:                     return std::string("any:") + pattern.text;
+        }
+    }
+
+    bool sameIdentity(const Cache::identity_t& a, const Cache::identity_t& b) {
+        return a.module == b.module &&
+            a.timeDateStamp == b.timeDateStamp &&
+            a.checkSum == b.checkSum &&
+            a.sizeOfImage == b.sizeOfImage;
+    }
+}
+
+namespace Cache
+{
+    identity_t identify(const std::string& name, HMODULE module) {
+        auto dosHeader = (PIMAGE_DOS_HEADER)module;
+        auto ntHeaders = (PIMAGE_NT_HEADERS)((std::uint8_t*)module + dosHeader->e_lfanew);
+        return {
+            name,
+            ntHeaders->FileHeader.TimeDateStamp,
+            ntHeaders->OptionalHeader.CheckSum,
+            ntHeaders->OptionalHeader.SizeOfImage,
+        };
+    }
+
+    void load(const std::string& path) {
+        cachePath = path;
+        entries.clear();
+        try {
+            YAML::Node root = YAML::LoadFile(path);
+            for (const auto& module : root) {
+                entry_t entry;
+                entry.identity.module = module.first.as<std::string>();
+                entry.identity.timeDateStamp = module.second["timeDateStamp"].as<uint32_t>();
+                entry.identity.checkSum = module.second["checkSum"].as<uint32_t>();
+                entry.identity.sizeOfImage = module.second["sizeOfImage"].as<uint32_t>();
+                for (const auto& signature : module.second["signatures"]) {
+                    std::string name = signature.first.as<std::string>();
+                    // Caches from before the section was part of the key, they are scanned for again
+                    if (name.find(':') == std::string::npos || !signature.second.IsSequence()) {
+                        continue;
+                    }
+                    entry.rvas[name] = { signature.second[0].as<uint32_t>(), signature.second[1].as<uint32_t>() };
+                }
+                entries[entry.identity.module] = entry;
+            }
+        }
+        catch (const YAML::Exception&) {
+            entries.clear();
+        }
+    }
+
+    void save() {
+        YAML::Emitter out;
+        out << YAML::BeginMap;
+        for (const auto& [name, entry] : entries) {
+            out << YAML::Key << name << YAML::Value << YAML::BeginMap;
+            out << YAML::Key << "timeDateStamp" << YAML::Value << YAML::Hex << entry.identity.timeDateStamp;
+            out << YAML::Key << "checkSum" << YAML::Value << YAML::Hex << entry.identity.checkSum;
+            out << YAML::Key << "sizeOfImage" << YAML::Value << YAML::Hex << entry.identity.sizeOfImage;
+            out << YAML::Key << "signatures" << YAML::Value << YAML::BeginMap;
+            for (const auto& [signature, hit] : entry.rvas) {
+                out << YAML::Key << YAML::DoubleQuoted << signature << YAML::Value;
+                out << YAML::Flow << YAML::BeginSeq << YAML::Hex << hit.rva << YAML::Dec << hit.count << YAML::EndSeq;
+            }
+            out << YAML::EndMap << YAML::EndMap;
+        }
+        out << YAML::EndMap;
+
+        std::ofstream file(cachePath, std::ios::trunc);
+        file << out.c_str() << std::endl;
+    }
+
+    bool lookup(const identity_t& identity, const Scanner::Pattern& pattern, uint32_t* rva, uint32_t* hits) {
+        auto entry = entries.find(identity.module);
+        if (entry == entries.end() || !sameIdentity(entry->second.identity, identity)) {
+            return false;
+        }
+        auto hit = entry->second.rvas.find(key(pattern));
+        if (hit == entry->second.rvas.end()) {
+            return false;
+        }
+        *rva = hit->second.rva;
+        *hits = hit->second.count;
+        return true;
+    }
+
+    void store(const identity_t& identity, const Scanner::Pattern& pattern, uint32_t rva, uint32_t hits) {
+        entry_t& entry = entries[identity.module];
+        if (!sameIdentity(entry.identity, identity)) {
+            entry.identity = identity;
+            entry.rvas.clear();
+        }
+        entry.rvas[key(pattern)] = { rva, hits };
+    }
+}
@@ -0,0 +1,143 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include <atomic>
+#include <cstdint>
+
+#include "safetyhook.hpp"
+
+#include "callbacks.hpp"
+#include "metrics.hpp"
+#include "hooklog.hpp"
+
+namespace
+{
+    Callbacks::derived_t derivedSlots[Callbacks::DERIVED_SLOTS];
+}
+
+namespace Callbacks
+{
+    std::atomic<const derived_t*> derivedCurrent = &derivedSlots[0];
+    HookState::Shared<textBubbleScaler_t> textBubbleScaler;
+    toggles_t toggles;
+
+    void publishDerived(const derived_t& next) {
+        static size_t slot = 0;
+        slot = (slot + 1) % DERIVED_SLOTS;
+        derivedSlots[slot] = next;
+        derivedCurrent.store(&derivedSlots[slot], std::memory_order_release);
+    }
+
+    void centerUi(SafetyHookContext& ctx) {
+        if (!enabled(toggles.centerUi)) {
+            return;
+        }
+        const derived_t& derived = loadDerived();
+        ctx.xmm0.f32[0] = derived.centerUiWidth;
+    }
+
+    void viewport(SafetyHookContext& ctx) {
+        if (!enabled(toggles.viewport)) {
+            return;
+        }
+        const derived_t& derived = loadDerived();
+        ctx.r8 = derived.viewportWidth;
+    }
+
+    void textBubblePlacement0(SafetyHookContext& ctx) {
+        if (!enabled(toggles.textBubblePlacement)) {
+            return;
+        }
+        const derived_t& derived = loadDerived();
+        // The division the second hook compares against is done once here, this hook
+        // only fires when the aspect ratio is read and not for every use of [r8]
+        if (METRICS_GUARD(*(float*)(ctx.rbx + 0x4) == derived.aspectRatio)) {
+            float value = ctx.xmm1.f32[0];
+            textBubbleScaler.store({ value / derived.aspectRatio, value / derived.normalizedAspectRatio });
+        }
+    }
+
+    void textBubblePlacement1(SafetyHookContext& ctx) {
+        if (!enabled(toggles.textBubblePlacement)) {
+            return;
+        }
+        textBubbleScaler_t scaler = textBubbleScaler.load();
+        if (METRICS_GUARD(ctx.xmm0.f32[0] == scaler.gameCalculated)) {
+            ctx.xmm0.f32[0] = scaler.corrected;
+        }
+    }
+
+    void combatOverlay(SafetyHookContext& ctx) {
+        if (!enabled(toggles.combatOverlay)) {
+            return;
+        }
+        const derived_t& derived = loadDerived();
+        if (METRICS_GUARD(ctx.r13 == 0x68 && ctx.r14 == 0)) {
+            if (derived.combatOverlayEnable == true) {
+                *(uint32_t*)(ctx.rdx + 0x280) = derived.combatOverlayScale;
+                *(uint32_t*)(ctx.rdx + 0x2B0) = 0xBF800000;
+            }
+            else {
+                *(uint32_t*)(ctx.rdx + 0x280) = 0;
+            }
+        }
+    }
+
+    void uiElements(SafetyHookContext& ctx) {
+        if (!enabled(toggles.uiElements)) {
+            return;
+        }
+        const derived_t& derived = loadDerived();
+        if (METRICS_GUARD(derived.mapOffset0 == *(uint32_t*)(ctx.rbx + 0x388) || derived.mapOffset1 == *(uint32_t*)(ctx.rbx + 0x388))) {
+            //HOOK_LOG("{:x}", ctx.rbx);
+            *(uint32_t*)(ctx.rbx + 0x388) = derived.mapOffsetCorrected;
+            *(uint32_t*)(ctx.rbx + 0x390) = *(uint32_t*)(ctx.rbx + 0x394);
+        }
+        else {
+            *(uint32_t*)(ctx.rbx + 0x388) = 0;
+            *(uint32_t*)(ctx.rbx + 0x390) = derived.uiWidth;
+        }
+    }
+
+    void cutscene(SafetyHookContext& ctx) {
+        if (!enabled(toggles.cutscene)) {
+            return;
+        }
+        const derived_t& derived = loadDerived();
+        *(float*)(ctx.rsp + 0x38) = *(float*)(ctx.rsp + 0x38) * derived.widthScalingFactor;
+        *(float*)(ctx.rsp + 0x3C) = *(float*)(ctx.rsp + 0x3C) * derived.widthScalingFactor;
+    }
+
+    void constrainAntiAliasing(SafetyHookContext& ctx) {
+        if (!enabled(toggles.constrainAntiAliasing)) {
+            return;
+        }
+        uint8_t antiAliasingVal = *(uint8_t*)(ctx.rdx + 0x10);
+        if (METRICS_GUARD(antiAliasingVal > 0x2)) {
+            *(uint8_t*)(ctx.rdx + 0x10) = 0x2;
+        }
+    }
+}
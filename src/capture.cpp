@@ -0,0 +1,138 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include <windows.h>
+#include <atomic>
+#include <array>
+#include <fstream>
+#include <vector>
+#include <utility>
+#include <cstring>
+
+#include "spdlog/spdlog.h"
+#include "safetyhook.hpp"
+
+#include "capture.hpp"
+#include "callbacks.hpp"
+
+#ifndef HOOK_CAPTURE_STRIDE
+#define HOOK_CAPTURE_STRIDE 64
+#endif
+
+namespace
+{
+    constexpr size_t SITES = Callbacks::sites.size();
+
+    std::atomic<uint64_t> calls[SITES];
+    std::atomic<size_t> reserved[SITES];
+    std::atomic<bool> ready[SITES][Capture::MAX_SAMPLES];
+    Capture::sample_t samples[SITES][Capture::MAX_SAMPLES];
+
+    // The window may point anywhere when a guard is not taken, so it is read without faulting
+    bool readWindow(const SafetyHookContext& ctx, const Callbacks::window_t& window, uint8_t* out) {
+        if (window.reg == nullptr) {
+            return true;
+        }
+        SIZE_T read = 0;
+        LPCVOID address = (LPCVOID)(ctx.*window.reg + window.displacement);
+        return ReadProcessMemory(GetCurrentProcess(), address, out, window.size, &read) && read == window.size;
+    }
+
+    template <size_t N>
+    void thunk(SafetyHookContext& ctx) {
+        constexpr const Callbacks::site_t& site = Callbacks::sites[N];
+        if (calls[N].fetch_add(1, std::memory_order_relaxed) % HOOK_CAPTURE_STRIDE != 0) {
+            site.callback(ctx);
+            return;
+        }
+        size_t slot = reserved[N].fetch_add(1, std::memory_order_relaxed);
+        if (slot >= Capture::MAX_SAMPLES) {
+            site.callback(ctx);
+            return;
+        }
+        Capture::sample_t& sample = samples[N][slot];
+        sample.site = N;
+        sample.before = ctx;
+        sample.scalerBefore = Callbacks::textBubbleScaler.load();
+        Capture::saveToggles(sample.toggles);
+        sample.windowValid = readWindow(ctx, site.window, sample.windowBefore);
+        site.callback(ctx);
+        sample.after = ctx;
+        sample.scalerAfter = Callbacks::textBubbleScaler.load();
+        if (sample.windowValid) {
+            readWindow(sample.before, site.window, sample.windowAfter);
+        }
+        ready[N][slot].store(true, std::memory_order_release);
+    }
+
+    template <size_t... N>
+    constexpr std::array<safetyhook::MidHookFn, sizeof...(N)> makeThunks(std::index_sequence<N...>) {
+        return { &thunk<N>... };
+    }
+
+    constexpr std::array<safetyhook::MidHookFn, SITES> thunks = makeThunks(std::make_index_sequence<SITES>{});
+}
+
+namespace Capture
+{
+    safetyhook::MidHookFn wrap(safetyhook::MidHookFn hook) {
+        for (size_t i = 0; i < SITES; i++) {
+            if (Callbacks::sites[i].callback == hook) {
+                return thunks[i];
+            }
+        }
+        return hook;
+    }
+
+    size_t save(const char* path) {
+        header_t header = {};
+        header.magic = FILE_MAGIC;
+        header.version = FILE_VERSION;
+        header.sampleSize = sizeof(sample_t);
+        header.derived = Callbacks::loadDerived();
+        std::vector<const sample_t*> complete;
+        for (size_t site = 0; site < SITES; site++) {
+            for (size_t slot = 0; slot < MAX_SAMPLES; slot++) {
+                if (ready[site][slot].load(std::memory_order_acquire)) {
+                    complete.push_back(&samples[site][slot]);
+                }
+            }
+        }
+        header.count = (uint32_t)complete.size();
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const sample_t* sample : complete) {
+            file.write(reinterpret_cast<const char*>(sample), sizeof(sample_t));
+        }
+        if (!file) {
+            spdlog::info("Capture : Failed to write {}", path);
+            return 0;
+        }
+        spdlog::info("Capture : Wrote {} samples to {}", header.count, path);
+        return header.count;
+    }
+}
@@ -0,0 +1,214 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <windows.h>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <cstdint>
+#include <cwchar>
+
+#include "display.hpp"
+
+namespace
+{
+    // Prefix of the class names of every window the fix creates itself
+    constexpr wchar_t OWN_CLASS_PREFIX[] = L"HackGULastRecodeFix";
+
+    std::mutex displayMutex;
+    std::vector<Display::monitor_t> cached;
+    bool valid = false;
+
+    void (*onChanged)() = nullptr;
+    HMONITOR gameMonitor = NULL;
+
+    BOOL CALLBACK addMonitor(HMONITOR handle, HDC, LPRECT, LPARAM param) {
+        auto list = reinterpret_cast<std::vector<Display::monitor_t>*>(param);
+        MONITORINFOEXW info = {};
+        info.cbSize = sizeof(info);
+        if (!GetMonitorInfoW(handle, &info)) {
+            return TRUE;
+        }
+        Display::monitor_t monitor = {};
+        monitor.handle = handle;
+        monitor.bounds = info.rcMonitor;
+        monitor.width = info.rcMonitor.right - info.rcMonitor.left;
+        monitor.height = info.rcMonitor.bottom - info.rcMonitor.top;
+        monitor.primary = (info.dwFlags & MONITORINFOF_PRIMARY) != 0;
+        DEVMODEW mode = {};
+        mode.dmSize = sizeof(mode);
+        if (EnumDisplaySettingsW(info.szDevice, ENUM_CURRENT_SETTINGS, &mode)) {
+            // The current mode is in physical pixels even when the process is not DPI aware
+            monitor.width = mode.dmPelsWidth;
+            monitor.height = mode.dmPelsHeight;
+            monitor.refreshRate = mode.dmDisplayFrequency;
+        }
+        list->push_back(monitor);
+        return TRUE;
+    }
+
+    BOOL CALLBACK addWindow(HWND window, LPARAM param) {
+        auto best = reinterpret_cast<std::pair<HWND, LONG>*>(param);
+        DWORD process = 0;
+        GetWindowThreadProcessId(window, &process);
+        if (process != GetCurrentProcessId() || !IsWindowVisible(window) || GetWindow(window, GW_OWNER) != NULL) {
+            return TRUE;
+        }
+        wchar_t className[64] = {};
+        GetClassNameW(window, className, 64);
+        if (wcsncmp(className, OWN_CLASS_PREFIX, wcslen(OWN_CLASS_PREFIX)) == 0) {
+            return TRUE;
+        }
+        RECT rect;
+        GetWindowRect(window, &rect);
+        LONG area = (rect.right - rect.left) * (rect.bottom - rect.top);
+        if (area > best->second) {
+            *best = { window, area };
+        }
+        return TRUE;
+    }
+
+    void checkGameMonitor() {
+        HWND window = Display::findGameWindow();
+        if (window == NULL) {
+            return;
+        }
+        HMONITOR monitor = MonitorFromWindow(window, MONITOR_DEFAULTTOPRIMARY);
+        if (monitor != gameMonitor) {
+            bool first = gameMonitor == NULL;
+            gameMonitor = monitor;
+            // The primary monitor is what was picked before the window existed
+            if (!first || monitor != MonitorFromWindow(NULL, MONITOR_DEFAULTTOPRIMARY)) {
+                onChanged();
+            }
+        }
+    }
+
+    void CALLBACK windowEvent(HWINEVENTHOOK, DWORD, HWND window, LONG object, LONG, DWORD, DWORD) {
+        if (object == OBJID_WINDOW && window != NULL && GetAncestor(window, GA_ROOT) == window) {
+            checkGameMonitor();
+        }
+    }
+
+    LRESULT CALLBACK displayProc(HWND window, UINT message, WPARAM wParam, LPARAM lParam) {
+        if (message == WM_DISPLAYCHANGE) {
+            Display::invalidate();
+            gameMonitor = NULL;
+            onChanged();
+            return 0;
+        }
+        return DefWindowProcW(window, message, wParam, lParam);
+    }
+
+    DWORD WINAPI displayWatch(LPVOID) {
+        WNDCLASSEXW windowClass = {};
+        windowClass.cbSize = sizeof(windowClass);
+        windowClass.lpfnWndProc = displayProc;
+        windowClass.hInstance = GetModuleHandleW(NULL);
+        windowClass.lpszClassName = L"HackGULastRecodeFixDisplay";
+        RegisterClassExW(&windowClass);
+        // Not a message only window, those do not get the WM_DISPLAYCHANGE broadcast
+        HWND window = CreateWindowExW(WS_EX_TOOLWINDOW, windowClass.lpszClassName, L"", WS_POPUP,
+            0, 0, 0, 0, NULL, NULL, windowClass.hInstance, NULL);
+        if (window == NULL) {
+            return 0;
+        }
+        SetWinEventHook(EVENT_OBJECT_SHOW, EVENT_OBJECT_SHOW, NULL, windowEvent,
+            GetCurrentProcessId(), 0, WINEVENT_OUTOFCONTEXT);
+        SetWinEventHook(EVENT_SYSTEM_MOVESIZEEND, EVENT_SYSTEM_MOVESIZEEND, NULL, windowEvent,
+            GetCurrentProcessId(), 0, WINEVENT_OUTOFCONTEXT);
+
+        MSG message;
+        while (GetMessageW(&message, NULL, 0, 0) > 0) {
+            DispatchMessageW(&message);
+        }
+        return 0;
+    }
+}
+
+namespace Display
+{
+    const std::vector<monitor_t>& monitors() {
+        std::scoped_lock lock(displayMutex);
+        if (!valid) {
+            cached.clear();
+            EnumDisplayMonitors(NULL, NULL, addMonitor, reinterpret_cast<LPARAM>(&cached));
+            std::stable_sort(cached.begin(), cached.end(), [](const monitor_t& a, const monitor_t& b) {
+                if (a.primary != b.primary) {
+                    return a.primary;
+                }
+                if (a.bounds.left != b.bounds.left) {
+                    return a.bounds.left < b.bounds.left;
+                }
+                return a.bounds.top < b.bounds.top;
+            });
+            valid = true;
+        }
+        return cached;
+    }
+
+    void invalidate() {
+        std::scoped_lock lock(displayMutex);
+        valid = false;
+    }
+
+    monitor_t resolve(int index, HWND window) {
+        std::vector<monitor_t> list;
+        {
+            const std::vector<monitor_t>& all = monitors();
+            std::scoped_lock lock(displayMutex);
+            list = all;
+        }
+        if (list.empty()) {
+            return {};
+        }
+        if (index >= 1 && (size_t)index <= list.size()) {
+            return list[index - 1];
+        }
+        HMONITOR handle = MonitorFromWindow(window, MONITOR_DEFAULTTOPRIMARY);
+        for (const monitor_t& monitor : list) {
+            if (monitor.handle == handle) {
+                return monitor;
+            }
+        }
+        return list.front();
+    }
+
+    HWND findGameWindow() {
+        std::pair<HWND, LONG> best = { NULL, 0 };
+        EnumWindows(addWindow, reinterpret_cast<LPARAM>(&best));
+        return best.first;
+    }
+
+    bool start(void (*changed)()) {
+        onChanged = changed;
+        HANDLE thread = CreateThread(NULL, 0, displayWatch, NULL, 0, NULL);
+        if (thread == NULL) {
+            return false;
+        }
+        CloseHandle(thread);
+        return true;
+    }
+}
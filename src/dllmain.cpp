@@ -26,37 +26,30 @@
  * @file dllmain.cpp
  * @brief Hack GU Last Recode Fix
  *
- * @note This DLL must spin indifinitely until the game exe itself closes and cleans
+ * @note This DLL must live indifinitely until the game exe itself closes and cleans
  * everything up. Typically with these kind of ASI fixes the DLL gets loaded early
  * into game code, injects and/or patches stuff, and unloads itself. For this game
  * we cannot do that given the structure of the game.
  *
  * The game is made of one exe and multiple DLL's where these DLL's are the actual game
- * code and data files. This DLL must spin indefinitely and keep track of what DLL is
+ * code and data files. This DLL must live indefinitely and keep track of what DLL is
  * currently loaded, inject the hooks and patches into that DLL, and then wait until
  * the DLL is unloaded, and rinse and repeat until the exe is closed down effectively
- * also forcefully terminating this DLL.
+ * also forcefully terminating this DLL. The waiting is done on loader notifications
+ * so the fix thread sleeps until a game DLL is actually mapped or unmapped.
  *
- * This DLL will actually cause a memory leak! But dont worry, it is practically
- * impossible for the game to crash because of it. The memory leak happens because we are
- * constantly appending safetyhook objects in the `centerUiHook` vector. These objects
- * we can never truly free because they contain pointers to hook locations that will
- * no longer exist when the game unloads the current loaded DLL. And when a new DLL
- * takes it place well the fix doesn't create a new hook as the object already exists
- * and the safetyhook library thinks the hook is still valid, my theory anyway. So
- * basically the fix will not work, when a new DLL is loaded say the chapter 2 DLL.
- * So we need to append the safetyhook objects into a vector so that we may keep
- * creating new ones. The reason we will never crash is because you would need to keep
- * changing DLL's a gazillion times over and then some to really make a dent in your
- * computers avaiable memory because Windows says "that's enough" and terminates the
- * process, humanly this is practically impossible to do, therefore we can cause this
- * leak to happen and never worry about any consequences from it.
+ * Every hook is owned by the game DLL it was installed into. When a game DLL is unloaded the
+ * loader tells us before it unmaps the DLL and waits for us, in that window all hooks owned by
+ * the DLL are destroyed. This restores the original bytes into the DLL that is going away and
+ * frees the trampolines of the hooks, which all come from a single arena reserved next to the DLL
+ * as it loads and released in one go, so memory stays flat no matter how many times the game
+ * switches between DLL's, and a stale hook object can never stop a new hook from being created
+ * when a DLL is loaded again.
  *
  */
 
 // System includes
 #include <windows.h>
-#include <psapi.h>
 #include <shlwapi.h>
 #include <fstream>
 #include <iostream>
@@ -69,15 +62,42 @@
 #include <cstdint>
 #include <algorithm>
 #include <bit>
+#include <map>
+#include <deque>
+#include <array>
+#include <atomic>
+#include <span>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
 
 // 3rd party includes
 #include "spdlog/spdlog.h"
+#include "spdlog/async.h"
 #include "spdlog/sinks/basic_file_sink.h"
 #include "yaml-cpp/yaml.h"
 #include "safetyhook.hpp"
 
 // Local includes
 #include "utils.hpp"
+#include "display.hpp"
+#include "watcher.hpp"
+#include "cache.hpp"
+#include "health.hpp"
+#include "hooks.hpp"
+#include "stub.hpp"
+#include "metrics.hpp"
+#include "hooklog.hpp"
+#include "patch.hpp"
+#include "resolution.hpp"
+#include "signatures.hpp"
+#include "callbacks.hpp"
+#ifdef HOOK_CAPTURE
+#include "capture.hpp"
+#endif
+#ifdef HOOK_TELEMETRY
+#include "telemetry.hpp"
+#endif
 
 // Macros
 #define VERSION "1.0.1"
@@ -87,6 +107,7 @@
 typedef struct resolution_t {
     int width;
     int height;
+    int monitor;
     float aspectRatio;
 } resolution_t;
 
@@ -98,23 +119,90 @@ typedef struct feature_t {
     combatOverlay_t combatOverlay;
 } feature_t;
 
+typedef struct fixes_t {
+    bool centerUi;
+    bool viewport;
+    bool textBubblePlacement;
+    bool combatOverlay;
+    bool uiElements;
+    bool cutscene;
+    bool constrainAntiAliasing;
+} fixes_t;
+
+typedef struct log_t {
+    spdlog::level::level_enum level;
+    spdlog::level::level_enum flushLevel;
+    int flushInterval;
+} log_t;
+
 typedef struct yml_t {
-    std::string name;
+    char name[64];
     bool masterEnable;
+    log_t log;
     resolution_t resolution;
     feature_t feature;
+    fixes_t fixes;
 } yml_t;
+static_assert(std::is_trivially_copyable_v<yml_t>);
+
+/**
+ * @brief Configuration used for every setting that is missing from the YAML file or invalid,
+ * and for all of them if the file cannot be read. Matches the file written by install.ps1.
+ *
+ */
+constexpr yml_t YML_DEFAULTS = {
+    "Hack GU Last Recode Fix",
+    true,
+    { spdlog::level::info, spdlog::level::warn, 3 },
+    { 0, 0, 0, 0.0f },
+    { { true } },
+    { true, true, true, true, true, true, true },
+};
+
+// Largest width or height accepted from the YAML file
+constexpr int YML_MAX_DIMENSION = 16384;
 
 // Globals
 HMODULE mainModule = GetModuleHandle(NULL);
 HMODULE baseModule = GetModuleHandle(NULL);
 std::string strBaseModule;
-int normalizedWidth = 0;
-int normalizedOffset = 0;
-float widthScalingFactor = 0;
-std::vector<SafetyMidHook> centerUiHook;
-YAML::Node config = YAML::LoadFile("HackGULastRecodeFix.yml");
-yml_t yml;
+size_t baseModuleIndex = 0;
+yml_t yml = YML_DEFAULTS;
+
+// Game DLL's that loaded while the previous one was still being waited on to unload
+std::deque<Watcher::event_t> pendingLoads;
+
+/**
+ * @brief A single resolved hook or patch of a fix.
+ * @details `rva` is relative to the game DLL base so the entry can be replayed onto a new
+ * mapping of the same DLL. Hooks have a `hook` callback, patches have the bytes to write in `patch`.
+ * Hooks that also have a `stub` are installed as a hand assembled stub instead of a mid hook,
+ * the `hook` callback is then only used if the stub cannot be built. Hooks with `guards` only
+ * enter their mid hook when all of them hold.
+ *
+ */
+typedef struct hookPlanEntry_t {
+    const char* fix;
+    uintptr_t rva;
+    safetyhook::MidHookFn hook;
+    Stub::emitter_t stub;
+    std::span<const Stub::guard_t> guards;
+    std::vector<uint8_t> patch;
+} hookPlanEntry_t;
+
+/**
+ * @brief Everything the fixes installed into one game DLL.
+ *
+ */
+typedef struct hookPlan_t {
+    Cache::identity_t identity;
+    std::vector<hookPlanEntry_t> entries;
+} hookPlan_t;
+
+std::map<std::string, hookPlan_t> hookPlans;
+
+// Patches of the fixes or the hook plan being applied, written together by `commitPatches`
+Patch::Transaction pendingPatches;
 
 /**
  * @brief All the valid game DLL's.
@@ -129,21 +217,51 @@ std::vector<std::string> gameDllTable = {
     "hackGU_vol4.dll",
 };
 
+/**
+ * @brief Bits of the game DLL's for `fix_t::modules`, in the order of `gameDllTable`.
+ *
+ */
+namespace GameDll {
+    constexpr uint32_t Terminal = 1 << 0;
+    constexpr uint32_t Title    = 1 << 1;
+    constexpr uint32_t Vol1     = 1 << 2;
+    constexpr uint32_t Vol2     = 1 << 3;
+    constexpr uint32_t Vol3     = 1 << 4;
+    constexpr uint32_t Vol4     = 1 << 5;
+    constexpr uint32_t Volumes  = Vol1 | Vol2 | Vol3 | Vol4;
+    constexpr uint32_t All      = Terminal | Title | Volumes;
+}
+
+// Address of the patched resolution table of every loaded game DLL, one per `GameDll` bit, or 0
+// Written by `resolutionTableFix` from the loader notification and read on the fix thread
+std::array<std::atomic<uintptr_t>, 32> resolutionTables = {};
+
 /**
  * @brief Initializes logging for the application.
  *
  * This function performs the following tasks:
- * 1. Initializes the spdlog logging library and sets up a file logger.
- * 2. Retrieves and logs the path and name of the executable module.
- * 3. Logs detailed information about the module to aid in debugging.
+ * 1. Initializes the spdlog logging library and sets up an asynchronous file logger.
+ * 2. Starts draining lines logged with `HOOK_LOG` from game threads into that logger.
+ * 3. Retrieves and logs the path and name of the executable module.
+ * 4. Logs detailed information about the module to aid in debugging.
+ *
+ * @details
+ * Formatting and writing to disk happens on a spdlog worker thread, a full queue overwrites the
+ * oldest message instead of blocking the thread that logs. Level and flush policy are applied
+ * by `logConfigure` once the YAML file has been read, until then everything is flushed.
  *
  * @return void
  */
 void logInit() {
     // spdlog initialisation
-    auto logger = spdlog::basic_logger_mt("HackGULastRecodeFix", "HackGULastRecodeFix.log", true);
+    spdlog::init_thread_pool(8192, 1);
+    auto sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>("HackGULastRecodeFix.log", true);
+    auto logger = std::make_shared<spdlog::async_logger>(
+        "HackGULastRecodeFix", sink, spdlog::thread_pool(), spdlog::async_overflow_policy::overrun_oldest
+    );
     spdlog::set_default_logger(logger);
-    spdlog::flush_on(spdlog::level::debug);
+    spdlog::flush_on(spdlog::level::trace);
+    HookLog::start(std::chrono::milliseconds(100));
 
     // Get game name and exe path
     WCHAR exePath[_MAX_PATH] = { 0 };
@@ -161,59 +279,473 @@ void logInit() {
     LOG("Module Addr: 0x{:x}", (uintptr_t)baseModule);
 }
 
+/**
+ * @brief Parses a log level from the YAML file.
+ *
+ * @param node Node holding the level name
+ * @param fallback Level to use if the node is missing or not a level name
+ * @return spdlog::level::level_enum
+ */
+spdlog::level::level_enum readLogLevel(const YAML::Node& node, spdlog::level::level_enum fallback) {
+    std::string name = node.as<std::string>("");
+    spdlog::level::level_enum level = spdlog::level::from_str(name);
+    // Unknown names come back as off
+    if (level == spdlog::level::off && name != "off") {
+        if (!name.empty()) {
+            LOG("Unknown log level '{}', using the default", name);
+        }
+        return fallback;
+    }
+    return level;
+}
+
 /**
  * @brief Reads and parses configuration settings from a YAML file.
  *
  * This function performs the following tasks:
- * 1. Reads general settings from the configuration file and assigns them to the `yml` structure.
- * 2. Initializes global settings if certain values are missing or default.
+ * 1. Loads the configuration file and parses its settings into `out`.
+ * 2. Falls back to `YML_DEFAULTS` for every setting that is missing or invalid.
  * 3. Logs the parsed configuration values for debugging purposes.
  *
- * @return void
+ * @details
+ * The file is loaded on the calling thread when this is called and the yaml-cpp node tree is
+ * freed again before returning, only the flat `yml_t` is kept. Nothing is read during static
+ * initialization, so loading the DLL costs the game nothing and a missing or broken file can be
+ * handled here.
+ *
+ * @param out Parsed configuration, all defaults if the file could not be read
+ * @return true if the file was read, false if it is missing or could not be parsed
  */
-void readYml() {
-    yml.name = config["name"].as<std::string>();
+bool readYml(yml_t* out) {
+    yml_t next = YML_DEFAULTS;
+    bool loaded = true;
+    try {
+        YAML::Node config = YAML::LoadFile("HackGULastRecodeFix.yml");
+
+        std::string name = config["name"].as<std::string>(next.name);
+        next.name[name.copy(next.name, sizeof(next.name) - 1)] = '\0';
 
-    yml.masterEnable = config["masterEnable"].as<bool>();
+        next.masterEnable = config["masterEnable"].as<bool>(next.masterEnable);
 
-    yml.resolution.width = config["resolution"]["width"].as<int>();
-    yml.resolution.height = config["resolution"]["height"].as<int>();
+        next.log.level = readLogLevel(config["log"]["level"], next.log.level);
+        next.log.flushLevel = readLogLevel(config["log"]["flushLevel"], next.log.flushLevel);
+        next.log.flushInterval = config["log"]["flushInterval"].as<int>(next.log.flushInterval);
 
-    yml.feature.combatOverlay.enable = config["features"]["combatOverlay"]["enable"].as<bool>();
+        next.resolution.width = config["resolution"]["width"].as<int>(next.resolution.width);
+        next.resolution.height = config["resolution"]["height"].as<int>(next.resolution.height);
+        next.resolution.monitor = config["resolution"]["monitor"].as<int>(next.resolution.monitor);
 
-    if (yml.resolution.width == 0 || yml.resolution.height == 0) {
-        std::pair<int, int> dimensions = Utils::GetDesktopDimensions();
-        yml.resolution.width  = dimensions.first;
-        yml.resolution.height = dimensions.second;
+        next.feature.combatOverlay.enable = config["features"]["combatOverlay"]["enable"].as<bool>(next.feature.combatOverlay.enable);
+
+        next.fixes.centerUi = config["fixes"]["centerUi"].as<bool>(next.fixes.centerUi);
+        next.fixes.viewport = config["fixes"]["viewport"].as<bool>(next.fixes.viewport);
+        next.fixes.textBubblePlacement = config["fixes"]["textBubblePlacement"].as<bool>(next.fixes.textBubblePlacement);
+        next.fixes.combatOverlay = config["fixes"]["combatOverlay"].as<bool>(next.fixes.combatOverlay);
+        next.fixes.uiElements = config["fixes"]["uiElements"].as<bool>(next.fixes.uiElements);
+        next.fixes.cutscene = config["fixes"]["cutscene"].as<bool>(next.fixes.cutscene);
+        next.fixes.constrainAntiAliasing = config["fixes"]["constrainAntiAliasing"].as<bool>(next.fixes.constrainAntiAliasing);
+    }
+    catch (const YAML::Exception& e) {
+        LOG("Failed to read HackGULastRecodeFix.yml: {}", e.what());
+        next = YML_DEFAULTS;
+        loaded = false;
+    }
+
+    if (next.log.flushInterval < 0) {
+        LOG("Invalid log flush interval {}, using the default", next.log.flushInterval);
+        next.log.flushInterval = YML_DEFAULTS.log.flushInterval;
+    }
+    if (next.resolution.width < 0 || next.resolution.width > YML_MAX_DIMENSION ||
+        next.resolution.height < 0 || next.resolution.height > YML_MAX_DIMENSION) {
+        LOG("Invalid resolution {}x{}, using the monitor resolution", next.resolution.width, next.resolution.height);
+        next.resolution.width = 0;
+        next.resolution.height = 0;
+    }
+    if (next.resolution.monitor < 0) {
+        LOG("Invalid monitor {}, using the monitor of the game window", next.resolution.monitor);
+        next.resolution.monitor = 0;
+    }
+    if (next.resolution.width == 0 || next.resolution.height == 0) {
+        Display::monitor_t monitor = Display::resolve(next.resolution.monitor, Display::findGameWindow());
+        next.resolution.width  = monitor.width;
+        next.resolution.height = monitor.height;
+    }
+    if (next.resolution.width == 0 || next.resolution.height == 0) {
+        LOG("Cannot get the monitor resolution, using 1920x1080");
+        next.resolution.width = 1920;
+        next.resolution.height = 1080;
     }
-    yml.resolution.aspectRatio = (float)yml.resolution.width / (float)yml.resolution.height;
-    normalizedWidth = (16.0f / 9.0f) * (float)yml.resolution.height;
-    normalizedOffset = (float)(yml.resolution.width - normalizedWidth) / 2.0f;
-    widthScalingFactor = (float)yml.resolution.width / (float)normalizedWidth;
+    next.resolution.aspectRatio = (float)next.resolution.width / (float)next.resolution.height;
 
-    LOG("Name: {}", yml.name);
-    LOG("MasterEnable: {}", yml.masterEnable);
-    LOG("Resolution.Width: {}", yml.resolution.width);
-    LOG("Resolution.Height: {}", yml.resolution.height);
-    LOG("Resolution.AspectRatio: {}", yml.resolution.aspectRatio);
-    LOG("Feature.CombatOverlay.Enable: {}", yml.feature.combatOverlay.enable);
+    LOG("Name: {}", next.name);
+    LOG("MasterEnable: {}", next.masterEnable);
+    LOG("Log.Level: {}", spdlog::level::to_string_view(next.log.level));
+    LOG("Log.FlushLevel: {}", spdlog::level::to_string_view(next.log.flushLevel));
+    LOG("Log.FlushInterval: {}", next.log.flushInterval);
+    LOG("Resolution.Width: {}", next.resolution.width);
+    LOG("Resolution.Height: {}", next.resolution.height);
+    LOG("Resolution.Monitor: {}", next.resolution.monitor);
+    LOG("Resolution.AspectRatio: {}", next.resolution.aspectRatio);
+    LOG("Feature.CombatOverlay.Enable: {}", next.feature.combatOverlay.enable);
+    LOG("Fixes.CenterUi: {}", next.fixes.centerUi);
+    LOG("Fixes.Viewport: {}", next.fixes.viewport);
+    LOG("Fixes.TextBubblePlacement: {}", next.fixes.textBubblePlacement);
+    LOG("Fixes.CombatOverlay: {}", next.fixes.combatOverlay);
+    LOG("Fixes.UiElements: {}", next.fixes.uiElements);
+    LOG("Fixes.Cutscene: {}", next.fixes.cutscene);
+    LOG("Fixes.ConstrainAntiAliasing: {}", next.fixes.constrainAntiAliasing);
+    *out = next;
+    return loaded;
+}
+
+/**
+ * @brief Applies the log level and flush policy from the configuration.
+ *
+ * @details
+ * Must be called after `readYml`. Messages at or above `flushLevel` are flushed right away,
+ * everything else is flushed every `flushInterval` seconds by spdlog.
+ *
+ * spdlog can replace its periodic flusher but not stop it, so once one is running a reload that
+ * sets `flushInterval` to 0 keeps the previous interval until the next start of the game, which
+ * is logged.
+ *
+ * @return void
+ */
+void logConfigure() {
+    // Interval of the running periodic flusher, 0 while there is none
+    static int activeFlushInterval = 0;
+    spdlog::set_level(yml.log.level);
+    spdlog::flush_on(yml.log.flushLevel);
+    if (yml.log.flushInterval > 0) {
+        spdlog::flush_every(std::chrono::seconds(yml.log.flushInterval));
+        activeFlushInterval = yml.log.flushInterval;
+    }
+    else if (activeFlushInterval > 0) {
+        LOG("A flush interval of 0 takes effect on the next start, still flushing every {}s", activeFlushInterval);
+    }
+}
+
+/**
+ * @brief Switches every fix on or off as set in the `fixes` section of the configuration.
+ *
+ * @details
+ * Must be called after `readYml`. Each fix has a byte in `Callbacks::toggles` that its hooks check
+ * before anything else, switching a fix is a single store and its hooks stay installed. Fixes the
+ * game DLL is already hooked for take the new setting on their next call.
+ *
+ * @return void
+ */
+void applyToggles() {
+    Callbacks::toggles.centerUi.store(yml.fixes.centerUi, std::memory_order_relaxed);
+    Callbacks::toggles.viewport.store(yml.fixes.viewport, std::memory_order_relaxed);
+    Callbacks::toggles.textBubblePlacement.store(yml.fixes.textBubblePlacement, std::memory_order_relaxed);
+    Callbacks::toggles.combatOverlay.store(yml.fixes.combatOverlay, std::memory_order_relaxed);
+    Callbacks::toggles.uiElements.store(yml.fixes.uiElements, std::memory_order_relaxed);
+    Callbacks::toggles.cutscene.store(yml.fixes.cutscene, std::memory_order_relaxed);
+    Callbacks::toggles.constrainAntiAliasing.store(yml.fixes.constrainAntiAliasing, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Computes every value the hook callbacks need from the parsed configuration.
+ *
+ * @details
+ * Must be called after `readYml`. The results are packed into a `derived_t` block so the callbacks
+ * never do any float division, rounding or conversion on the game's render thread, and published
+ * with `Callbacks::publishDerived`.
+ *
+ * @return void
+ */
+void deriveConstants() {
+    int normalizedWidth = (16.0f / 9.0f) * (float)yml.resolution.height;
+    int normalizedOffset = (float)(yml.resolution.width - normalizedWidth) / 2.0f;
+    float widthScalingFactor = (float)yml.resolution.width / (float)normalizedWidth;
     LOG("Normalized Width: {}", normalizedWidth);
     LOG("Normalized Offset: {}", normalizedOffset);
     LOG("Width Scaling Factor: {}", widthScalingFactor);
+
+    Callbacks::derived_t derived = {};
+    derived.centerUiWidth = static_cast<float>(yml.resolution.width) * widthScalingFactor;
+    derived.widthScalingFactor = widthScalingFactor;
+    derived.aspectRatio = yml.resolution.aspectRatio;
+    derived.normalizedAspectRatio = std::bit_cast<float>(0x3FE38E39);
+    derived.viewportWidth = yml.resolution.width * 2;
+    derived.uiWidth = yml.resolution.width;
+    derived.mapOffset0 = static_cast<uint32_t>((yml.resolution.width / 682.0f) * 40.0f + 0.5f);
+    derived.mapOffset1 = static_cast<uint32_t>((yml.resolution.width / 682.0f) * std::bit_cast<float>(0x4227799a) + 0.5f);
+    derived.mapOffsetCorrected = normalizedOffset + static_cast<uint32_t>((static_cast<float>(normalizedWidth) / 682.0f) * 40.0f + 0.5f);
+    derived.combatOverlayScale = static_cast<uint32_t>(1.0f / ((float)yml.resolution.width / 2.0f));
+    derived.resolutionHeight = yml.resolution.height;
+    derived.combatOverlayEnable = yml.feature.combatOverlay.enable;
+    derived.masterEnable = yml.masterEnable;
+    Callbacks::publishDerived(derived);
 }
 
 /**
- * @brief Centers the UI of the game to 16:9 aspect ratio.
+ * @brief Where a signature was found in the current game DLL.
+ * @details `rva` is the first of `count` hits relative to the game DLL base, or
+ * `Cache::NOT_PRESENT` without a hit. `cached` signatures were taken from the signature cache.
  *
- * This function performs the following tasks:
- * 1. Checks if the master enable is enabled based on the configuration.
- * 2. Searches for a specific memory pattern in the base module.
- * 3. Hooks at the identified pattern to change game logic.
+ */
+typedef struct signatureHit_t {
+    uint32_t rva;
+    uint32_t count;
+    bool cached;
+} signatureHit_t;
+
+/**
+ * @brief Scans the current game DLL for a set of signatures.
  *
  * @details
- * The function uses a pattern scan to find a specific byte sequence in the memory of the base module.
- * If the pattern is found, it is hooked and the game logic is modified.
+ * The game DLL's are large and walking the whole image once per fix is expensive, so the
+ * signatures of all fixes are handed to the scanner together and it walks the image only once.
+ *
+ * The game DLL's are also the same every time they are loaded, so the address of the first hit
+ * of every signature is kept in a cache file keyed by the module identity. When the cache has an
+ * entry for a signature it is confirmed with a single compare at the cached address and the scan
+ * is skipped, only signatures that miss the cache are scanned for and the cache is updated.
+ * Signatures without any hit are recorded as `Cache::NOT_PRESENT` so a game DLL they are not part
+ * of is not scanned for them again. The number of hits is cached along with the first one, so a
+ * signature that is ambiguous stays ambiguous when it is taken from the cache.
  *
+ * @param patterns The signatures to scan for.
+ * @param hits Receives the hits of every signature, in the order of `patterns`.
+ *
+ * @return void
+ */
+void scanSignatures(const std::vector<Scanner::Pattern>& patterns, std::vector<signatureHit_t>* hits) {
+    Cache::identity_t identity = Cache::identify(strBaseModule, baseModule);
+    hits->assign(patterns.size(), { Cache::NOT_PRESENT, 0, false });
+
+    std::vector<Scanner::Pattern> misses;
+    std::vector<size_t> missIndex;
+    for (size_t i = 0; i < patterns.size(); ++i) {
+        uint32_t rva;
+        uint32_t count;
+        bool cached = Cache::lookup(identity, patterns[i], &rva, &count);
+        if (cached && rva == Cache::NOT_PRESENT) {
+            (*hits)[i].cached = true;
+            continue;
+        }
+        if (cached && Utils::patternMatch(baseModule, rva, patterns[i])) {
+            (*hits)[i] = { rva, count, true };
+        }
+        else {
+            misses.push_back(patterns[i]);
+            missIndex.push_back(i);
+        }
+    }
+    LOG("{} of {} signatures resolved from cache", patterns.size() - misses.size(), patterns.size());
+    if (misses.empty()) {
+        return;
+    }
+
+    std::vector<std::vector<uint64_t>> missHits;
+    Utils::patternScan(baseModule, misses, &missHits);
+    for (size_t i = 0; i < misses.size(); ++i) {
+        signatureHit_t hit = { Cache::NOT_PRESENT, (uint32_t)missHits[i].size(), false };
+        if (missHits[i].size() > 0) {
+            hit.rva = (uint32_t)(missHits[i][0] - (uint64_t)baseModule);
+        }
+        (*hits)[missIndex[i]] = hit;
+        Cache::store(identity, misses[i], hit.rva, hit.count);
+    }
+    Cache::save();
+}
+
+/**
+ * @brief Installs a single hook plan entry into the current game DLL.
+ *
+ * @param entry Entry to install
+ * @return void
+ */
+void applyHookPlanEntry(const hookPlanEntry_t& entry) {
+    uintptr_t absAddr = (uintptr_t)baseModule + entry.rva;
+    std::shared_ptr<safetyhook::Allocator> arena = Hooks::arena(baseModule);
+#if !defined(HOOK_METRICS) && !defined(HOOK_CAPTURE)
+    // Stubs run no C++ so they cannot be measured or recorded, those builds use their mid hook callback
+    if (entry.stub != nullptr) {
+        SafetyHookInline hook;
+        safetyhook::Allocation code;
+        if (Stub::create(arena, reinterpret_cast<void*>(absAddr), entry.stub, &hook, &code)) {
+            Hooks::add(baseModule, std::move(hook), std::move(code));
+            return;
+        }
+        LOG("{} stub could not be built, falling back to mid hook", entry.fix);
+    }
+    if (entry.stub == nullptr && !entry.guards.empty()) {
+        SafetyHookInline hook;
+        SafetyMidHook midHook;
+        safetyhook::Allocation code;
+        if (Stub::createGuarded(arena, reinterpret_cast<void*>(absAddr), entry.guards, entry.hook, &hook, &midHook, &code)) {
+            Hooks::add(baseModule, std::move(hook), std::move(midHook), std::move(code));
+            return;
+        }
+        LOG("{} guard could not be built, falling back to mid hook", entry.fix);
+    }
+#endif
+    if (entry.hook != nullptr) {
+        safetyhook::MidHookFn hook = entry.hook;
+#ifdef HOOK_CAPTURE
+        hook = Capture::wrap(hook);
+#endif
+#ifdef HOOK_METRICS
+        hook = Metrics::wrap(std::format("{}+{:x}", entry.fix, entry.rva).c_str(), hook);
+#endif
+        auto midHook = SafetyMidHook::create(arena, reinterpret_cast<void*>(absAddr), hook);
+        if (!midHook) {
+            LOG("{} could not be hooked @ {:s}+{:x}", entry.fix, strBaseModule, entry.rva);
+            return;
+        }
+        Hooks::add(baseModule, std::move(*midHook));
+    }
+    else {
+        pendingPatches.add(absAddr, entry.patch.data(), entry.patch.size());
+    }
+}
+
+/**
+ * @brief Hooks the current game DLL and records the hook in its hook plan.
+ *
+ * @param fix Name of the fix installing the hook
+ * @param rva Address to hook relative to the game DLL base
+ * @param hook Callback of the hook
+ * @param stub Optional stub to install instead of a mid hook running `hook`
+ * @param guards Optional guards `hook` is only entered for, ignored with a `stub`
+ * @return void
+ */
+void planHook(
+    const char* fix,
+    uintptr_t rva,
+    safetyhook::MidHookFn hook,
+    Stub::emitter_t stub = nullptr,
+    std::span<const Stub::guard_t> guards = {}
+) {
+    hookPlanEntry_t entry = { fix, rva, hook, stub, guards, {} };
+    applyHookPlanEntry(entry);
+    hookPlans[strBaseModule].entries.push_back(entry);
+}
+
+/**
+ * @brief Patches the current game DLL and records the patch in its hook plan.
+ * @details The patch is only queued, it is written by the next `commitPatches`.
+ *
+ * @param fix Name of the fix applying the patch
+ * @param rva Address to patch relative to the game DLL base
+ * @param bytes Bytes to write
+ * @param size Number of bytes to write
+ * @return void
+ */
+void planPatch(const char* fix, uintptr_t rva, const void* bytes, size_t size) {
+    const uint8_t* begin = static_cast<const uint8_t*>(bytes);
+    hookPlanEntry_t entry = { fix, rva, nullptr, nullptr, {}, std::vector<uint8_t>(begin, begin + size) };
+    applyHookPlanEntry(entry);
+    hookPlans[strBaseModule].entries.push_back(entry);
+}
+
+/**
+ * @brief Writes every queued patch into the current game DLL at once.
+ *
+ * @details
+ * The queued patches are grouped by page so the protection of each run of pages is changed once
+ * for all of them instead of twice per patch. If a run cannot be made writable nothing is written.
+ *
+ * @return void
+ */
+void commitPatches() {
+    size_t count = pendingPatches.size();
+    if (count == 0) {
+        return;
+    }
+    if (pendingPatches.commit()) {
+        LOG("Wrote {} patches, {} page runs reprotected", count, pendingPatches.protectedRuns());
+    }
+    else {
+        LOG("Failed to write {} patches", count);
+    }
+    pendingPatches = {};
+}
+
+/**
+ * @brief Replays the hook plan of the current game DLL if it was loaded before.
+ *
+ * @details
+ * The first time a game DLL is loaded the fixes scan for their signatures and record every
+ * hook and patch they make in the hook plan of that DLL. When the same DLL comes back later in
+ * the session, ie when going back and forth between chapters, the plan is rebased onto the new
+ * module base and installed directly, skipping the scanning and all the per fix work.
+ *
+ * A plan is only replayed if the module identity matches the one it was recorded for.
+ *
+ * @return true if a plan was replayed, false if the fixes need to run
+ */
+bool replayHookPlan() {
+    Cache::identity_t identity = Cache::identify(strBaseModule, baseModule);
+    auto plan = hookPlans.find(strBaseModule);
+    if (plan != hookPlans.end() &&
+        plan->second.identity.timeDateStamp == identity.timeDateStamp &&
+        plan->second.identity.checkSum == identity.checkSum &&
+        plan->second.identity.sizeOfImage == identity.sizeOfImage) {
+        for (const auto& entry : plan->second.entries) {
+            applyHookPlanEntry(entry);
+        }
+        commitPatches();
+        LOG("Replayed {} hooks and patches @ {:s}", plan->second.entries.size(), strBaseModule);
+        return true;
+    }
+    hookPlans[strBaseModule] = { identity, {} };
+    return false;
+}
+
+/**
+ * @brief How a fix changes the game DLL.
+ *
+ */
+enum class FixKind {
+    Hook,
+    Patch,
+};
+
+/**
+ * @brief A single hook or patch of a fix, everything `resolveFixes` needs to apply it.
+ * @details `offset` is added to the hit of `pattern`, or of the first of `fallbacks` with a
+ * single hit if `pattern` does not have exactly one. Hooks run `hook`, or `stub` if it
+ * is set, and only enter `hook` when all of `guards` hold. Patches write `patchSize` bytes from
+ * `patch`. `modules` holds the `GameDll` bits of
+ * the game DLL's the fix applies to, it is not applied to any other.
+ *
+ */
+typedef struct fix_t {
+    const char* name;
+    Scanner::Pattern pattern;
+    std::span<const Scanner::Pattern> fallbacks;
+    intptr_t offset;
+    bool (*enabled)();
+    FixKind kind;
+    safetyhook::MidHookFn hook;
+    Stub::emitter_t stub;
+    std::span<const Stub::guard_t> guards;
+    const void* patch;
+    size_t patchSize;
+    uint32_t modules;
+} fix_t;
+
+bool masterEnabled() {
+    return yml.masterEnable;
+}
+
+bool combatOverlayEnabled() {
+    return yml.masterEnable && yml.feature.combatOverlay.enable;
+}
+
+// Skips the mid hook while the fix is switched off
+constexpr std::array<Stub::guard_t, 1> centerUiGuards = {
+    Stub::byteSet(&Callbacks::toggles.centerUi),
+};
+
+/**
+ * @brief Centers the UI of the game to 16:9 aspect ratio.
+ *
+ * @details
  * How was this found?
  * This was a huge rabbit hole... It first started by accidently modifying some memory which had 0x3F80_0000
  * which when modified would squish the entire game inwards. This discovery made me dig much deeper into
@@ -224,53 +756,21 @@ void readYml() {
  * found out that if we multiply the width here it was essentially being used as a scaler values in
  * other parts of the code to calculate actual placements of UI elements.
  *
- * @return void
  */
-void centerUiFix() {
-    const char* patternFind = "C7 87 ?? ?? ?? ?? ?? ?? ?? ??    F3 41 0F 5C C1";
-    uintptr_t  hookOffset = 0;
-
-    bool enable = yml.masterEnable;
-    LOG("Fix {}", enable ? "Enabled" : "Disabled");
-    if (enable) {
-        std::vector<uint64_t> addr;
-        Utils::patternScan(baseModule, patternFind, &addr);
-        if (addr.size() > 0) {
-            uint8_t* hit = (uint8_t*)addr[0];
-            uintptr_t absAddr = (uintptr_t)hit;
-            uintptr_t relAddr = (uintptr_t)hit - (uintptr_t)baseModule;
-            LOG("Found '{}' @ {:s}+{:x}", patternFind, strBaseModule, relAddr);
-            uintptr_t hookAbsAddr = absAddr + hookOffset;
-            uintptr_t hookRelAddr = relAddr + hookOffset;
-            // Memory leak caused by SafetyMidHook object
-            centerUiHook.push_back(
-                safetyhook::create_mid(
-                    reinterpret_cast<void*>(hookAbsAddr),
-                    [](SafetyHookContext& ctx) {
-                        ctx.xmm0.f32[0] = static_cast<float>(yml.resolution.width) * widthScalingFactor;
-                    }
-                )
-            );
-            LOG("Hooked @ {:s}+{:x}", strBaseModule, hookRelAddr);
-        }
-        else {
-            LOG("Did not find '{}'", patternFind);
-        }
-    }
-}
+constexpr fix_t centerUiFix = {
+    .name = "centerUiFix",
+    .pattern = Signatures::centerUi.pattern(),
+    .enabled = masterEnabled,
+    .kind = FixKind::Hook,
+    .hook = Callbacks::centerUi,
+    .guards = centerUiGuards,
+    .modules = GameDll::All,
+};
 
 /**
  * @brief Fixes the aspect ratio by applying the correct one based on provided resolution in YAML file.
  *
- * This function performs the following tasks:
- * 1. Checks if the master enable is enabled based on the configuration.
- * 2. Searches for a specific memory pattern in the base module.
- * 3. Patches the identified pattern.
- *
  * @details
- * The function uses a pattern scan to find a specific byte sequence in the memory of the base module.
- * If the pattern is found, it is patched with a specific byte sequence.
- *
  * How was this found?
  * This is a common pattern to look for. The pattern we want to find '39 8E E3 3F' is the aspect ratio
  * for 16:9, and given 16:9 is the defacto standard as of writing this so its not surprising to find this
@@ -279,43 +779,31 @@ void centerUiFix() {
  * Changing this value to anything else, ie the hex for 32:9 or 21:9, causes the game to render at for that
  * resolution regardless of the resolution of the game window or viewport.
  *
- * @return void
  */
-void aspectRatioFix() {
-    const char* patternFind  = "39 8E E3 3F";
-    std::string patternPatch = Utils::bytesToString(&yml.resolution.aspectRatio, sizeof(float));
-    LOG("{}", patternPatch);
-
-    bool enable = yml.masterEnable;
-    LOG("Fix {}", enable ? "Enabled" : "Disabled");
-    if (enable) {
-        std::vector<uint64_t> addr;
-        Utils::patternScan(baseModule, patternFind, &addr);
-        if (addr.size() > 0) {
-            uint8_t* hit = (uint8_t*)addr[0];
-            uintptr_t absAddr = (uintptr_t)hit;
-            uintptr_t relAddr = (uintptr_t)hit - (uintptr_t)baseModule;
-            Utils::patch(absAddr, patternPatch.c_str());
-            LOG("Patched '{}' with '{}' @ {:s}+{:x}", patternFind, patternPatch, strBaseModule, relAddr);
-        }
-        else {
-            LOG("Did not find '{}'", patternFind);
-        }
-    }
-}
+constexpr fix_t aspectRatioFix = {
+    .name = "aspectRatioFix",
+    .pattern = Signatures::aspectRatio.pattern(),
+    .enabled = masterEnabled,
+    .kind = FixKind::Patch,
+    .patch = &yml.resolution.aspectRatio,
+    .patchSize = sizeof(float),
+    .modules = GameDll::All,
+};
+
+// Skips the mid hook while the fix is switched off
+constexpr std::array<Stub::guard_t, 1> viewportGuards = {
+    Stub::byteSet(&Callbacks::toggles.viewport),
+};
+
+// Tried in order when the signature has no unique hit, ie after a game update
+constexpr std::array<Scanner::Pattern, 1> viewportFallbacks = {
+    Signatures::viewportFallback.pattern(),
+};
 
 /**
  * @brief Fixes the viewport and expands game rendering area to fit the screen.
  *
- * This function performs the following tasks:
- * 1. Checks if the master enable is enabled based on the configuration.
- * 2. Searches for a specific memory pattern in the base module.
- * 3. Patches the identified pattern.
- *
  * @details
- * The function uses a pattern scan to find a specific byte sequence in the memory of the base module.
- * If the pattern is found, it is patched with a specific byte sequence.
- *
  * How was this found?
  * Working with other games a common pattern is '39 8E E3 38' which is sometimes used in the assembly
  * to get the width and height of the screen in a 16:9 aspect ratio regardless of what the screen resolution
@@ -331,57 +819,66 @@ void aspectRatioFix() {
  * multiply it by 2 effectively cancelling out the shift operation performed above. This will let the
  * game render the viewport up to the desired resolution provided within the yml file.
  *
+ */
+constexpr fix_t viewportFix = {
+    .name = "viewportFix",
+    .pattern = Signatures::viewport.pattern(),
+    .fallbacks = viewportFallbacks,
+    .enabled = masterEnabled,
+    .kind = FixKind::Hook,
+    .hook = Callbacks::viewport,
+    .guards = viewportGuards,
+    .modules = GameDll::All,
+};
+
+/**
+ * @brief Stub for `textBubblePlacement1Fix`, does exactly what its mid hook callback does.
+ *
+ * @details
+ * This hook sits on a `[r8]` read that is shared by a lot of other stuff and fires thousands of
+ * times per frame, so only rax and the flags are saved. Writing xmm0 with `movss` clears its upper
+ * lanes which the callback version keeps, this is fine here as the hooked `shufps xmm0,xmm0,0`
+ * broadcasts the low lane over all of them right after.
+ *
+ * The published pair is loaded with a single 8 byte move and kept on the stack, both halves are
+ * then read from that copy so they always come from the same publish of the first hook. Nothing
+ * is done while `Callbacks::toggles_t::textBubblePlacement` is off.
+ *
+ * @param a Assembler to emit into
  * @return void
  */
-void viewportFix() {
-    const char* patternFind  = "41 D1 F8    41 8B C0    C1 E8 1F";
-    uintptr_t  hookOffset = 0;
-
-    bool enable = yml.masterEnable;
-    LOG("Fix {}", enable ? "Enabled" : "Disabled");
-    if (enable) {
-        std::vector<uint64_t> addr;
-        Utils::patternScan(baseModule, patternFind, &addr);
-        if (addr.size() > 0) {
-            uint8_t* hit = (uint8_t*)addr[0];
-            uintptr_t absAddr = (uintptr_t)hit;
-            uintptr_t relAddr = (uintptr_t)hit - (uintptr_t)baseModule;
-            // Utils::patch(absAddr, patternPatch);
-            // LOG("Patched '{}' with '{}' @ ABS::0x{:x} REL::0x{:x}", patternFind, patternPatch, absAddr, relAddr);
-            LOG("Found '{}' @ {:s}+{:x}", patternFind, strBaseModule, relAddr);
-            // Memory leak caused by SafetyMidHook object
-            uintptr_t hookAbsAddr = absAddr + hookOffset;
-            uintptr_t hookRelAddr = relAddr + hookOffset;
-            centerUiHook.push_back(
-                safetyhook::create_mid(
-                    reinterpret_cast<void*>(hookAbsAddr),
-                    [](SafetyHookContext& ctx) {
-                        ctx.r8 = yml.resolution.width * 2;
-                    }
-                )
-            );
-            LOG("Hooked @ {:s}+{:x}", strBaseModule, hookRelAddr);
-        }
-        else {
-            LOG("Did not find '{}'", patternFind);
-        }
-    }
+void textBubblePlacementStub(Stub::Assembler& a) {
+    using namespace Stub;
+    a.emit(ZYDIS_MNEMONIC_PUSHFQ, {});
+    a.emit(ZYDIS_MNEMONIC_PUSH, { reg(ZYDIS_REGISTER_RAX) });
+    a.emit(ZYDIS_MNEMONIC_MOV, { reg(ZYDIS_REGISTER_RAX), imm((int64_t)&Callbacks::toggles.textBubblePlacement) });
+    a.emit(ZYDIS_MNEMONIC_CMP, { mem(ZYDIS_REGISTER_RAX, 0, 1), imm(0) });
+    size_t off = a.jump(ZYDIS_MNEMONIC_JZ);
+    a.emit(ZYDIS_MNEMONIC_MOV, { reg(ZYDIS_REGISTER_RAX), imm((int64_t)&Callbacks::textBubbleScaler) });
+    a.emit(ZYDIS_MNEMONIC_MOV, { reg(ZYDIS_REGISTER_RAX), mem(ZYDIS_REGISTER_RAX, 0, 8) });
+    a.emit(ZYDIS_MNEMONIC_PUSH, { reg(ZYDIS_REGISTER_RAX) });
+    a.emit(ZYDIS_MNEMONIC_UCOMISS, { reg(ZYDIS_REGISTER_XMM0), mem(ZYDIS_REGISTER_RSP, offsetof(Callbacks::textBubbleScaler_t, gameCalculated), 4) });
+    size_t unordered = a.jump(ZYDIS_MNEMONIC_JP);
+    size_t notEqual = a.jump(ZYDIS_MNEMONIC_JNZ);
+    a.emit(ZYDIS_MNEMONIC_MOVSS, { reg(ZYDIS_REGISTER_XMM0), mem(ZYDIS_REGISTER_RSP, offsetof(Callbacks::textBubbleScaler_t, corrected), 4) });
+    a.bind(unordered);
+    a.bind(notEqual);
+    // Drop the copy of the pair, then restore rax
+    a.emit(ZYDIS_MNEMONIC_POP, { reg(ZYDIS_REGISTER_RAX) });
+    a.bind(off);
+    a.emit(ZYDIS_MNEMONIC_POP, { reg(ZYDIS_REGISTER_RAX) });
+    a.emit(ZYDIS_MNEMONIC_POPFQ, {});
 }
 
+// Skips the mid hook while the fix is switched off
+constexpr std::array<Stub::guard_t, 1> textBubblePlacement0Guards = {
+    Stub::byteSet(&Callbacks::toggles.textBubblePlacement),
+};
+
 /**
  * @brief Corrects text bubble placement.
  *
- * This function performs the following tasks:
- * 1. Checks if the master enable is enabled based on the configuration.
- * 2. Searches for a specific memory pattern in the base module.
- * 3. Hooks at the identified pattern to inject a new value into xmm0.f32[0] when a particular
- *    value is encountered.
- *
  * @details
- * The function uses a pattern scan to find a specific byte sequence in the memory of the base module.
- * If the pattern is found, a hook is created at an offset from the found pattern address. The hook
- * injects a new value into xmm0.f32[0] when a particular value is encountered.
- *
  * How was this found?
  * This is a long and agregious rabbit hole, which started by analyzing UI element objects and
  * subobjects and while there were gains made on that front, ultimately nothing of value came
@@ -432,89 +929,47 @@ void viewportFix() {
  * are basically undoing the offset introduced as the game thinks that rendering is 16:9 and so
  * scales the text bubbles appropriately to where they should be, above NPC heads.
  *
- * In the code below we dont take the chance of doing a raw comparision we calculate exactly
+ * In `Callbacks::textBubblePlacement0` we dont take the chance of doing a raw comparision we calculate exactly
  * what both values should be as to not throw off anything and garentee a comparison correctly.
  *
- * @return void
- *
  * @note As an added bonus this fix also seems to have fixed the drift that the ingame cursor
  * experiences when you approach NPCs to interact with them.
  */
-void textBubblePlacementFix() {
-    const char* patternFind0  = "F3 0F 5E 4B 04    48 89 47 04";
-    const char* patternFind1  = "F3 41 0F 10 48 08    0F C6 C0 00";
-    uintptr_t  hookOffset = 0;
-    static float scaler = 0;
-
-    bool enable = yml.masterEnable;
-    LOG("Fix {}", enable ? "Enabled" : "Disabled");
-    if (enable) {
-        std::vector<uint64_t> addr;
-        Utils::patternScan(baseModule, patternFind0, &addr);
-        if (addr.size() > 0) {
-            uint8_t* hit = (uint8_t*)addr[0];
-            uintptr_t absAddr = (uintptr_t)hit;
-            uintptr_t relAddr = (uintptr_t)hit - (uintptr_t)baseModule;
-            LOG("Found '{}' @ {:s}+{:x}", patternFind0, strBaseModule, relAddr);
-            // Memory leak caused by SafetyMidHook object
-            uintptr_t hookAbsAddr = absAddr + hookOffset;
-            uintptr_t hookRelAddr = relAddr + hookOffset;
-            centerUiHook.push_back(
-                safetyhook::create_mid(
-                    reinterpret_cast<void*>(hookAbsAddr),
-                    [](SafetyHookContext& ctx) {
-                        if (*(float*)(ctx.rbx + 0x4) == yml.resolution.aspectRatio) {
-                            scaler = ctx.xmm1.f32[0];
-                        }
-                    }
-                )
-            );
-            LOG("Hooked @ {:s}+{:x}", strBaseModule, hookRelAddr);
-        }
-        else {
-            LOG("Did not find '{}'", patternFind0);
-        }
-        addr.clear();
-        Utils::patternScan(baseModule, patternFind1, &addr);
-        if (addr.size() > 0) {
-            uint8_t* hit = (uint8_t*)addr[0];
-            uintptr_t absAddr = (uintptr_t)hit;
-            uintptr_t relAddr = (uintptr_t)hit - (uintptr_t)baseModule;
-            LOG("Found '{}' @ {:s}+{:x}", patternFind1, strBaseModule, relAddr);
-            // Memory leak caused by SafetyMidHook object
-            uintptr_t hookAbsAddr = absAddr + hookOffset;
-            uintptr_t hookRelAddr = relAddr + hookOffset;
-            centerUiHook.push_back(
-                safetyhook::create_mid(
-                    reinterpret_cast<void*>(hookAbsAddr),
-                    [](SafetyHookContext& ctx) {
-                        float gameCalculatedScaler = scaler / yml.resolution.aspectRatio;
-                        if (ctx.xmm0.f32[0] == gameCalculatedScaler) {
-                            ctx.xmm0.f32[0] = scaler / std::bit_cast<float>(0x3FE38E39);
-                        }
-                    }
-                )
-            );
-            LOG("Hooked @ {:s}+{:x}", strBaseModule, hookRelAddr);
-        }
-        else {
-            LOG("Did not find '{}'", patternFind1);
-        }
-    }
-}
+constexpr fix_t textBubblePlacement0Fix = {
+    .name = "textBubblePlacement0Fix",
+    .pattern = Signatures::textBubblePlacement0.pattern(),
+    .enabled = masterEnabled,
+    .kind = FixKind::Hook,
+    .hook = Callbacks::textBubblePlacement0,
+    .guards = textBubblePlacement0Guards,
+    .modules = GameDll::Volumes,
+};
 
 /**
- * @brief Fixes combat overlay.
+ * @brief Second hook of the text bubble placement fix, see `textBubblePlacement0Fix`.
  *
- * This function performs the following tasks:
- * 1. Checks if the master enable is enabled based on the configuration.
- * 2. Searches for a specific memory pattern in the base module.
- * 3. Hooks at the identified pattern to modify game logic.
+ */
+constexpr fix_t textBubblePlacement1Fix = {
+    .name = "textBubblePlacement1Fix",
+    .pattern = Signatures::textBubblePlacement1.pattern(),
+    .enabled = masterEnabled,
+    .kind = FixKind::Hook,
+    .hook = Callbacks::textBubblePlacement1,
+    .stub = textBubblePlacementStub,
+    .modules = GameDll::Volumes,
+};
+
+// Same as the first checks of `Callbacks::combatOverlay`, most calls go straight back to the game
+constexpr std::array<Stub::guard_t, 3> combatOverlayGuards = {
+    Stub::byteSet(&Callbacks::toggles.combatOverlay),
+    Stub::registerEquals(ZYDIS_REGISTER_R13, 0x68),
+    Stub::registerEquals(ZYDIS_REGISTER_R14, 0),
+};
+
+/**
+ * @brief Fixes combat overlay.
  *
  * @details
- * The function uses a pattern scan to find a specific byte sequence in the memory of the base module.
- * The hook injects new game logic.
- *
  * How was this found?
  * Due to the center UI fix the combat overlay is affected which causes it to shrink back to 16:9,
  * which at larger aspect ratios we do not want as the overlay does not cover the whole screen and
@@ -536,61 +991,72 @@ void textBubblePlacementFix() {
  * at rdx+280 and rdx+2B0. What is nice is that the calculation is simple for the replacement values
  * and works at all aspect ratios.
  *
+ */
+constexpr fix_t combatOverlayFix = {
+    .name = "combatOverlayFix",
+    .pattern = Signatures::combatOverlay.pattern(),
+    .enabled = combatOverlayEnabled,
+    .kind = FixKind::Hook,
+    .hook = Callbacks::combatOverlay,
+    .guards = combatOverlayGuards,
+    .modules = GameDll::Volumes,
+};
+
+// Tried in order when the signature has no unique hit, ie after a game update
+constexpr std::array<Scanner::Pattern, 1> uiElementsFallbacks = {
+    Signatures::uiElementsFallback.pattern(),
+};
+
+/**
+ * @brief Stub for `uiElementsFix`, does exactly what its mid hook callback does.
+ *
+ * @details
+ * This hook fires for every UI element on every frame, so instead of capturing the full context
+ * only rax, rcx and the flags are saved. rax is loaded from `derivedCurrent` so it points at the
+ * published `derived_t` block, and ecx is used as scratch. Nothing is done while
+ * `Callbacks::toggles_t::uiElements` is off.
+ *
+ * @param a Assembler to emit into
  * @return void
  */
-void combatOverlayFix() {
-    const char* patternFind  = "8B 82 80 02 00 00    4C 8D 89 E0 00 00 00";
-    uintptr_t  hookOffset = 0;
-
-    bool enable = yml.masterEnable && yml.feature.combatOverlay.enable;
-    LOG("Fix {}", enable ? "Enabled" : "Disabled");
-    if (enable) {
-        std::vector<uint64_t> addr;
-        Utils::patternScan(baseModule, patternFind, &addr);
-        if (addr.size() > 0) {
-            uint8_t* hit = (uint8_t*)addr[0];
-            uintptr_t absAddr = (uintptr_t)hit;
-            uintptr_t relAddr = (uintptr_t)hit - (uintptr_t)baseModule;
-            LOG("Found '{}' @ {:s}+{:x}", patternFind, strBaseModule, relAddr);
-            // Memory leak caused by SafetyMidHook object
-            uintptr_t hookAbsAddr = absAddr + hookOffset;
-            uintptr_t hookRelAddr = relAddr + hookOffset;
-            centerUiHook.push_back(
-                safetyhook::create_mid(
-                    reinterpret_cast<void*>(hookAbsAddr),
-                    [](SafetyHookContext& ctx) {
-                        if (ctx.r13 == 0x68 && ctx.r14 == 0) {
-                            if (yml.feature.combatOverlay.enable == true) {
-                                *(uint32_t*)(ctx.rdx + 0x280) = 1.0f / ((float)yml.resolution.width / 2.0f);
-                                *(uint32_t*)(ctx.rdx + 0x2B0) = 0xBF800000;
-                            }
-                            else {
-                                *(uint32_t*)(ctx.rdx + 0x280) = 0;
-                            }
-                        }
-                    }
-                )
-            );
-            LOG("Hooked @ {:s}+{:x}", strBaseModule, hookRelAddr);
-        }
-        else {
-            LOG("Did not find '{}'", patternFind);
-        }
-    }
+void uiElementsStub(Stub::Assembler& a) {
+    using namespace Stub;
+    a.emit(ZYDIS_MNEMONIC_PUSHFQ, {});
+    a.emit(ZYDIS_MNEMONIC_PUSH, { reg(ZYDIS_REGISTER_RAX) });
+    a.emit(ZYDIS_MNEMONIC_PUSH, { reg(ZYDIS_REGISTER_RCX) });
+    a.emit(ZYDIS_MNEMONIC_MOV, { reg(ZYDIS_REGISTER_RAX), imm((int64_t)&Callbacks::toggles.uiElements) });
+    a.emit(ZYDIS_MNEMONIC_CMP, { mem(ZYDIS_REGISTER_RAX, 0, 1), imm(0) });
+    size_t off = a.jump(ZYDIS_MNEMONIC_JZ);
+    a.emit(ZYDIS_MNEMONIC_MOV, { reg(ZYDIS_REGISTER_RAX), imm((int64_t)&Callbacks::derivedCurrent) });
+    a.emit(ZYDIS_MNEMONIC_MOV, { reg(ZYDIS_REGISTER_RAX), mem(ZYDIS_REGISTER_RAX, 0, 8) });
+    a.emit(ZYDIS_MNEMONIC_MOV, { reg(ZYDIS_REGISTER_ECX), mem(ZYDIS_REGISTER_RBX, 0x388, 4) });
+    a.emit(ZYDIS_MNEMONIC_CMP, { reg(ZYDIS_REGISTER_ECX), mem(ZYDIS_REGISTER_RAX, offsetof(Callbacks::derived_t, mapOffset0), 4) });
+    size_t isMap0 = a.jump(ZYDIS_MNEMONIC_JZ);
+    a.emit(ZYDIS_MNEMONIC_CMP, { reg(ZYDIS_REGISTER_ECX), mem(ZYDIS_REGISTER_RAX, offsetof(Callbacks::derived_t, mapOffset1), 4) });
+    size_t isMap1 = a.jump(ZYDIS_MNEMONIC_JZ);
+    // Not the map, render the full width
+    a.emit(ZYDIS_MNEMONIC_MOV, { mem(ZYDIS_REGISTER_RBX, 0x388, 4), imm(0) });
+    a.emit(ZYDIS_MNEMONIC_MOV, { reg(ZYDIS_REGISTER_ECX), mem(ZYDIS_REGISTER_RAX, offsetof(Callbacks::derived_t, uiWidth), 4) });
+    a.emit(ZYDIS_MNEMONIC_MOV, { mem(ZYDIS_REGISTER_RBX, 0x390, 4), reg(ZYDIS_REGISTER_ECX) });
+    size_t done = a.jump(ZYDIS_MNEMONIC_JMP);
+    // The map, apply the 16:9 corrected offset
+    a.bind(isMap0);
+    a.bind(isMap1);
+    a.emit(ZYDIS_MNEMONIC_MOV, { reg(ZYDIS_REGISTER_ECX), mem(ZYDIS_REGISTER_RAX, offsetof(Callbacks::derived_t, mapOffsetCorrected), 4) });
+    a.emit(ZYDIS_MNEMONIC_MOV, { mem(ZYDIS_REGISTER_RBX, 0x388, 4), reg(ZYDIS_REGISTER_ECX) });
+    a.emit(ZYDIS_MNEMONIC_MOV, { reg(ZYDIS_REGISTER_ECX), mem(ZYDIS_REGISTER_RBX, 0x394, 4) });
+    a.emit(ZYDIS_MNEMONIC_MOV, { mem(ZYDIS_REGISTER_RBX, 0x390, 4), reg(ZYDIS_REGISTER_ECX) });
+    a.bind(done);
+    a.bind(off);
+    a.emit(ZYDIS_MNEMONIC_POP, { reg(ZYDIS_REGISTER_RCX) });
+    a.emit(ZYDIS_MNEMONIC_POP, { reg(ZYDIS_REGISTER_RAX) });
+    a.emit(ZYDIS_MNEMONIC_POPFQ, {});
 }
 
 /**
  * @brief Fixes UI elements.
  *
- * This function performs the following tasks:
- * 1. Checks if the master enable is enabled based on the configuration.
- * 2. Searches for a specific memory pattern in the base module.
- * 3. Hooks at the identified pattern to modify game logic.
- *
  * @details
- * The function uses a pattern scan to find a specific byte sequence in the memory of the base module.
- * The hook injects new game logic.
- *
  * How was this found?
  * This is a build off of `centerUiFix`. The consequence of centering the UI is that this does not modify
  * the coordinates of where and how much of the UI elements should be shown, THIS IS NOT PLACEMENT RELATED.
@@ -618,7 +1084,8 @@ void combatOverlayFix() {
  * In the hook as well we do some additional calculations `mapOffset` and `mapOffsetCorrected`. The `mapOffset`
  * calculation is what the game calculates which we recalculate exactly as the game does it so that we have a good
  * and exact value for comparison. The `mapOffsetCorrected` is the same as `mapOffset` but with a correction applied
- * using the width of the screen if it was 16:9.
+ * using the width of the screen if it was 16:9. Both are computed once by `deriveConstants` as they only depend on
+ * the resolution, the hook itself only compares against them.
  *
  * So now the if statements, we really only need to worry about the map everything else we can hardcode 0 and width
  * resolution respectively.
@@ -636,64 +1103,27 @@ void combatOverlayFix() {
  * components for other parts dont have the same issue as the map, where you only want a portion of it to show, the
  * other UI parts can be FULL display hence we can render the entire thing without worry by hardcoding.
  *
- * @return void
  */
-void uiElementsFix() {
-    const char* patternFind  = "48 8B 74 24 38    48 8B 5C 24 40    48 83 C4 20    5F    C3    48 8D 81 88 03 00 00";
-    uintptr_t  hookOffset = 0;
-
-    bool enable = yml.masterEnable;
-    LOG("Fix {}", enable ? "Enabled" : "Disabled");
-    if (enable) {
-        std::vector<uint64_t> addr;
-        Utils::patternScan(baseModule, patternFind, &addr);
-        if (addr.size() > 0) {
-            uint8_t* hit = (uint8_t*)addr[0];
-            uintptr_t absAddr = (uintptr_t)hit;
-            uintptr_t relAddr = (uintptr_t)hit - (uintptr_t)baseModule;
-            LOG("Found '{}' @ {:s}+{:x}", patternFind, strBaseModule, relAddr);
-            // Memory leak caused by SafetyMidHook object
-            uintptr_t hookAbsAddr = absAddr + hookOffset;
-            uintptr_t hookRelAddr = relAddr + hookOffset;
-            centerUiHook.push_back(
-                safetyhook::create_mid(
-                    reinterpret_cast<void*>(hookAbsAddr),
-                    [](SafetyHookContext& ctx) {
-                        uint32_t mapOffset0 = static_cast<uint32_t>((yml.resolution.width / 682.0f) * 40.0f + 0.5f);
-                        uint32_t mapOffset1 = static_cast<uint32_t>((yml.resolution.width / 682.0f) * std::bit_cast<float>(0x4227799a) + 0.5f);
-                        uint32_t mapOffsetCorrected = static_cast<uint32_t>((static_cast<float>(normalizedWidth) / 682.0f) * 40.0f + 0.5f);
-                        if (mapOffset0 == *(uint32_t*)(ctx.rbx + 0x388) || mapOffset1 == *(uint32_t*)(ctx.rbx + 0x388)) {
-                            //LOG("{:x}", ctx.rbx);
-                            *(uint32_t*)(ctx.rbx + 0x388) = normalizedOffset + mapOffsetCorrected;
-                            *(uint32_t*)(ctx.rbx + 0x390) = *(uint32_t*)(ctx.rbx + 0x394);
-                        }
-                        else {
-                            *(uint32_t*)(ctx.rbx + 0x388) = 0;
-                            *(uint32_t*)(ctx.rbx + 0x390) = yml.resolution.width;
-                        }
-                    }
-                )
-            );
-            LOG("Hooked @ {:s}+{:x}", strBaseModule, hookRelAddr);
-        }
-        else {
-            LOG("Did not find '{}'", patternFind);
-        }
-    }
-}
+constexpr fix_t uiElementsFix = {
+    .name = "uiElementsFix",
+    .pattern = Signatures::uiElements.pattern(),
+    .fallbacks = uiElementsFallbacks,
+    .enabled = masterEnabled,
+    .kind = FixKind::Hook,
+    .hook = Callbacks::uiElements,
+    .stub = uiElementsStub,
+    .modules = GameDll::All,
+};
+
+// Skips the mid hook while the fix is switched off
+constexpr std::array<Stub::guard_t, 1> cutsceneGuards = {
+    Stub::byteSet(&Callbacks::toggles.cutscene),
+};
 
 /**
  * @brief Fixes aspect ratio for cutscenes.
  *
- * This function performs the following tasks:
- * 1. Checks if the master enable is enabled based on the configuration.
- * 2. Searches for a specific memory pattern in the base module.
- * 3. Hooks at the identified pattern to modify game logic.
- *
  * @details
- * The function uses a pattern scan to find a specific byte sequence in the memory of the base module.
- * The hook injects new game logic.
- *
  * How was this found?
  * The cutscene fix is interesting because the fix is in the same function as where the aspect ratio is
  * read. In the assembly of the game this function is guarded with an if statement, where if the object
@@ -726,54 +1156,26 @@ void uiElementsFix() {
  * rsp+38 and rsp+3C by that scaling factor. And just like that we get in engine cutscenes to render at the
  * desired aspect ratio.
  *
- * @return void
  */
-void cutsceneFix() {
-    const char* patternFind  = "0F 28 CA    F3 0F 59 89 A4 03 00 00";
-    uintptr_t  hookOffset = 0;
-
-    bool enable = yml.masterEnable;
-    LOG("Fix {}", enable ? "Enabled" : "Disabled");
-    if (enable) {
-        std::vector<uint64_t> addr;
-        Utils::patternScan(baseModule, patternFind, &addr);
-        if (addr.size() > 0) {
-            uint8_t* hit = (uint8_t*)addr[0];
-            uintptr_t absAddr = (uintptr_t)hit;
-            uintptr_t relAddr = (uintptr_t)hit - (uintptr_t)baseModule;
-            LOG("Found '{}' @ {:s}+{:x}", patternFind, strBaseModule, relAddr);
-            // Memory leak caused by SafetyMidHook object
-            uintptr_t hookAbsAddr = absAddr + hookOffset;
-            uintptr_t hookRelAddr = relAddr + hookOffset;
-            centerUiHook.push_back(
-                safetyhook::create_mid(
-                    reinterpret_cast<void*>(hookAbsAddr),
-                    [](SafetyHookContext& ctx) {
-                        *(float*)(ctx.rsp + 0x38) = *(float*)(ctx.rsp + 0x38) * widthScalingFactor;
-                        *(float*)(ctx.rsp + 0x3C) = *(float*)(ctx.rsp + 0x3C) * widthScalingFactor;
-                    }
-                )
-            );
-            LOG("Hooked @ {:s}+{:x}", strBaseModule, hookRelAddr);
-        }
-        else {
-            LOG("Did not find '{}'", patternFind);
-        }
-    }
-}
+constexpr fix_t cutsceneFix = {
+    .name = "cutsceneFix",
+    .pattern = Signatures::cutscene.pattern(),
+    .enabled = masterEnabled,
+    .kind = FixKind::Hook,
+    .hook = Callbacks::cutscene,
+    .guards = cutsceneGuards,
+    .modules = GameDll::All,
+};
+
+// Skips the mid hook while the fix is switched off
+constexpr std::array<Stub::guard_t, 1> constrainAntiAliasingGuards = {
+    Stub::byteSet(&Callbacks::toggles.constrainAntiAliasing),
+};
 
 /**
- * @brief Fixes aspect ratio for cutscenes.
- *
- * This function performs the following tasks:
- * 1. Checks if the master enable is enabled based on the configuration.
- * 2. Searches for a specific memory pattern in the base module.
- * 3. Hooks at the identified pattern to modify game logic.
+ * @brief Constrains anti-aliasing to medium.
  *
  * @details
- * The function uses a pattern scan to find a specific byte sequence in the memory of the base module.
- * The hook injects new game logic.
- *
  * How was this found?
  * The anti-aliasing fix was relatively simple to find. We can use the assumption that the code for
  * the game graphics settings in general are all in tight proximity to each other. At first analysis
@@ -802,93 +1204,370 @@ void cutsceneFix() {
  * visual fidelity, but this is a trade off we have to make in order to get the mod to work. As I am
  * a bit too lazy to figure out how and where the game uses the HIGH setting that causes this break.
  *
+ */
+constexpr fix_t constrainAntiAliasing = {
+    .name = "constrainAntiAliasing",
+    .pattern = Signatures::constrainAntiAliasing.pattern(),
+    .enabled = masterEnabled,
+    .kind = FixKind::Hook,
+    .hook = Callbacks::constrainAntiAliasing,
+    .guards = constrainAntiAliasingGuards,
+    .modules = GameDll::All,
+};
+
+/**
+ * @brief Every fix, applied in this order by `resolveFixes`.
+ *
+ */
+constexpr std::array<const fix_t*, 9> fixRegistry = {
+    &constrainAntiAliasing,
+    &viewportFix,
+    &aspectRatioFix,
+    &centerUiFix,
+    &uiElementsFix,
+    &combatOverlayFix,
+    &textBubblePlacement0Fix,
+    &textBubblePlacement1Fix,
+    &cutsceneFix,
+};
+
+/**
+ * @brief Applies every fix of `fixRegistry` to the current game DLL.
+ *
+ * @details
+ * The signatures of all fixes that are enabled and apply to the current game DLL are handed to
+ * `scanSignatures` together, fallbacks included, so the image is walked once for all of them.
+ * Fixes that do not apply to the current game DLL are never scanned for. Every fix is then
+ * hooked or patched at the first of its signatures with a single hit and recorded in the hook
+ * plan, all patches are written together at the end. A fix without such a signature is
+ * ambiguous and applied at the first hit of its own signature, if it has one.
+ *
+ * How every fix resolved is written to the health report, so a game update that breaks a
+ * signature shows up there without going through the log.
+ *
  * @return void
  */
-void constrainAntiAliasing() {
-    const char* patternFind  = "44 0F BE 4A 10    44 0F BE 52 11";
-    uintptr_t  hookOffset = 0;
-
-    bool enable = yml.masterEnable;
-    LOG("Fix {}", enable ? "Enabled" : "Disabled");
-    if (enable) {
-        std::vector<uint64_t> addr;
-        Utils::patternScan(baseModule, patternFind, &addr);
-        if (addr.size() > 0) {
-            uint8_t* hit = (uint8_t*)addr[0];
-            uintptr_t absAddr = (uintptr_t)hit;
-            uintptr_t relAddr = (uintptr_t)hit - (uintptr_t)baseModule;
-            LOG("Found '{}' @ {:s}+{:x}", patternFind, strBaseModule, relAddr);
-            // Memory leak caused by SafetyMidHook object
-            uintptr_t hookAbsAddr = absAddr + hookOffset;
-            uintptr_t hookRelAddr = relAddr + hookOffset;
-            centerUiHook.push_back(
-                safetyhook::create_mid(
-                    reinterpret_cast<void*>(hookAbsAddr),
-                    [](SafetyHookContext& ctx) {
-                        uint8_t antiAliasingVal = *(uint8_t*)(ctx.rdx + 0x10);
-                        if (antiAliasingVal > 0x2) {
-                            *(uint8_t*)(ctx.rdx + 0x10) = 0x2;
-                        }
-                    }
-                )
-            );
-            LOG("Hooked @ {:s}+{:x}", strBaseModule, hookRelAddr);
+void resolveFixes() {
+    Health::report_t report = { Cache::identify(strBaseModule, baseModule), 0, {} };
+    std::vector<const fix_t*> fixes;
+    std::vector<size_t> firstPattern;
+    std::vector<Scanner::Pattern> patterns;
+    for (const fix_t* fix : fixRegistry) {
+        if (!fix->enabled()) {
+            LOG("{} Disabled", fix->name);
+            report.fixes.push_back({ fix->name, Health::Status::Disabled, 0, 0, {} });
+            continue;
+        }
+        if ((fix->modules & (1u << baseModuleIndex)) == 0) {
+            LOG("{} not used by {:s}", fix->name, strBaseModule);
+            report.fixes.push_back({ fix->name, Health::Status::Unused, 0, 0, {} });
+            continue;
+        }
+        LOG("{} Enabled", fix->name);
+        fixes.push_back(fix);
+        firstPattern.push_back(patterns.size());
+        patterns.push_back(fix->pattern);
+        patterns.insert(patterns.end(), fix->fallbacks.begin(), fix->fallbacks.end());
+    }
+    firstPattern.push_back(patterns.size());
+
+    LARGE_INTEGER frequency, begin, end;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&begin);
+    std::vector<signatureHit_t> hits;
+    scanSignatures(patterns, &hits);
+    QueryPerformanceCounter(&end);
+    report.scanMicroseconds = (end.QuadPart - begin.QuadPart) * 1000000 / frequency.QuadPart;
+
+    for (size_t i = 0; i < fixes.size(); ++i) {
+        const fix_t* fix = fixes[i];
+        Health::fix_t health = { fix->name, Health::Status::Missing, 0, 0, {} };
+        size_t chosen = patterns.size();
+        for (size_t j = firstPattern[i]; j < firstPattern[i + 1]; ++j) {
+            health.signatures.push_back({ patterns[j].text, hits[j].count, hits[j].cached });
+            if (chosen == patterns.size() && hits[j].count == 1) {
+                chosen = j;
+            }
+        }
+        if (chosen != patterns.size()) {
+            health.status = chosen == firstPattern[i] ? Health::Status::Resolved : Health::Status::Fallback;
+        }
+        else if (hits[firstPattern[i]].count > 1) {
+            chosen = firstPattern[i];
+            health.status = Health::Status::Ambiguous;
+            LOG("{} found {} hits of '{}', using the first", fix->name, hits[chosen].count, fix->pattern.text);
         }
         else {
-            LOG("Did not find '{}'", patternFind);
+            LOG("{} did not find '{}' or any of its {} fallbacks", fix->name, fix->pattern.text, fix->fallbacks.size());
+            report.fixes.push_back(std::move(health));
+            continue;
+        }
+        if (health.status == Health::Status::Fallback) {
+            LOG("{} did not find '{}', using fallback '{}'", fix->name, fix->pattern.text, patterns[chosen].text);
         }
+
+        uintptr_t relAddr = (uintptr_t)hits[chosen].rva + fix->offset;
+        health.signature = chosen - firstPattern[i];
+        health.rva = (uint32_t)relAddr;
+        report.fixes.push_back(std::move(health));
+        if (fix->kind == FixKind::Hook) {
+            planHook(fix->name, relAddr, fix->hook, fix->stub, fix->guards);
+            LOG("{} hooked '{}' @ {:s}+{:x}", fix->name, patterns[chosen].text, strBaseModule, relAddr);
+        }
+        else {
+            planPatch(fix->name, relAddr, fix->patch, fix->patchSize);
+            LOG("{} patched '{}' with '{}' @ {:s}+{:x}",
+                fix->name,
+                patterns[chosen].text,
+                Utils::bytesToString(fix->patch, fix->patchSize).view(),
+                strBaseModule,
+                relAddr
+            );
+        }
+    }
+    commitPatches();
+    if (!Health::save("HackGULastRecodeFix.health.json", report)) {
+        LOG("Failed to write HackGULastRecodeFix.health.json");
     }
 }
 
 /**
- * @brief Wait for a game DLL from the `gameDllTable` to load.
+ * @brief Patches the resolution table of a game DLL in memory as soon as it is mapped.
  *
+ * @details
+ * The game reads the resolution table of a game DLL once, very early on while the DLL loads,
+ * which is far too early for the fixes that run once `waitForGameDllLoad` returns. This is why
+ * the table used to only be patched on disk by `HackGULastRecodePatch`.
+ *
+ * This runs from the loader notification instead, after the DLL has been mapped but before any of
+ * its initializers ran, so the table is patched before anything in the DLL can read it and the
+ * files on disk stay untouched. Each run logs whether it happened at map time and how long the
+ * loader was held up, a DLL that was already loaded when the watcher started is patched too late
+ * and needs the on disk patch.
+ *
+ * This runs inside the loader lock, so the table is searched for on this thread only with the
+ * single signature `Utils::patternScan`. The batch scan starts worker threads which cannot start
+ * while the loader lock is held. The address of the patched table is kept in `resolutionTables`
+ * so `reloadConfig` can rewrite it when the resolution changes. A DLL without the original table has most likely been patched on disk already. The
+ * resolution is taken from the published `derived_t` block as `yml` belongs to the fix thread.
+ *
+ * @param module Base of the game DLL
+ * @param index Index of the game DLL in `gameDllTable`
+ * @param mapping True if called at map time
  * @return void
  */
-void waitForGameDllLoad() {
-    // Get the current process handle
-    HANDLE hProcess = GetCurrentProcess();
+void resolutionTableFix(HMODULE module, size_t index, bool mapping) {
+    const Callbacks::derived_t& derived = Callbacks::loadDerived();
+    if (!derived.masterEnable) {
+        return;
+    }
+    LARGE_INTEGER frequency, begin, end;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&begin);
 
-    // Array to store module handles
-    HMODULE hMods[1024];
-    DWORD cbNeeded;
+    std::vector<uint64_t> addr;
+    Utils::patternScan(module, Resolution::originalTable.pattern(), &addr);
+    if (addr.empty()) {
+        LOG("Did not find resolution table in {}, it may be patched on disk already", gameDllTable[index]);
+        return;
+    }
 
-    // Get the list of modules in the process
-    while(1) {
-        if (EnumProcessModules(hProcess, hMods, sizeof(hMods), &cbNeeded)) {
-            size_t moduleCount = cbNeeded / sizeof(HMODULE);
-            for (size_t i = 0; i < moduleCount; ++i) {
-                char moduleName[MAX_PATH];
-                if (GetModuleFileNameA(hMods[i], moduleName, sizeof(moduleName))) {
-                    std::string strModuleName(moduleName);
-                    for (const auto& strTargetModuleName : gameDllTable) {
-                        if (strModuleName.find(strTargetModuleName) != std::string::npos) {
-                            LOG("{} Loaded", strTargetModuleName);
-                            baseModule = GetModuleHandle(strTargetModuleName.c_str());
-                            strBaseModule = strTargetModuleName;
-                            return;
-                        }
-                    }
-                }
+    Resolution::table_t table = Resolution::makeTable(derived.uiWidth, derived.resolutionHeight);
+    Patch::Transaction transaction;
+    transaction.add(addr[0], table.data(), sizeof(table));
+    bool patched = transaction.commit();
+    if (patched) {
+        resolutionTables[index].store((uintptr_t)addr[0], std::memory_order_release);
+    }
+    QueryPerformanceCounter(&end);
+    LOG("{} resolution table with {}x{} @ {:s}+{:x} {} in {}us",
+        patched ? "Patched" : "Failed to patch",
+        derived.uiWidth,
+        derived.resolutionHeight,
+        gameDllTable[index],
+        addr[0] - (uint64_t)module,
+        mapping ? "before its initializers ran" : "after it was loaded, this is too late",
+        (end.QuadPart - begin.QuadPart) * 1000000 / frequency.QuadPart
+    );
+}
+
+/**
+ * @brief Notify the fix thread that the displays or the monitor of the game window changed.
+ * @details Called on the display watching thread, the resolution is derived again by
+ * `reloadConfig` on the fix thread like after a change to the YAML file.
+ *
+ * @return void
+ */
+void displayChanged() {
+    LOG("Display changed");
+    Watcher::notify();
+}
+
+/**
+ * @brief Reads the YAML file again after it changed and applies it to the running game.
+ *
+ * @details
+ * Called on the fix thread when the watcher reports that the YAML file was written, or that the
+ * displays changed which matters when the resolution is taken from the monitor. The new
+ * configuration is derived and published with `Callbacks::publishDerived`, so every hook picks up the new
+ * values on its next call without taking a lock. The aspect ratio is not read by a hook but
+ * patched into the game DLL, the patch is rewritten in every hook plan and in the current game
+ * DLL if one is loaded. The same goes for the resolution table of the current game DLL when the
+ * resolution changed, ie after the game window moved to another monitor, so the table always
+ * agrees with what the hooks use. The game itself only reads the table while the DLL loads, a
+ * new resolution in the table is used from the next load of the DLL on.
+ *
+ * Enabling or disabling a fix does not install or remove its hooks, this only takes effect the
+ * next time a game DLL loads. The hook plans only hold the fixes that were enabled when they were
+ * recorded, so they are all dropped when that changes and every game DLL is resolved again on
+ * its next load. A file that fails to parse is ignored and the previous configuration stays in
+ * place.
+ *
+ * @param loaded True if `baseModule` is a loaded game DLL
+ * @return void
+ */
+void reloadConfig(bool loaded) {
+    yml_t next;
+    if (!readYml(&next)) {
+        LOG("Keeping the previous configuration");
+        return;
+    }
+    std::array<bool, fixRegistry.size()> wasEnabled;
+    for (size_t i = 0; i < fixRegistry.size(); ++i) {
+        wasEnabled[i] = fixRegistry[i]->enabled();
+    }
+    Callbacks::derived_t previous = Callbacks::loadDerived();
+    yml = next;
+    logConfigure();
+    deriveConstants();
+    applyToggles();
+#ifdef HOOK_TELEMETRY
+    Telemetry::setResolution(yml.resolution.width, yml.resolution.height);
+#endif
+
+    const Callbacks::derived_t& derived = Callbacks::loadDerived();
+    uintptr_t resolutionTable = loaded ? resolutionTables[baseModuleIndex].load(std::memory_order_acquire) : 0;
+    if (resolutionTable != 0 && derived.masterEnable &&
+        (derived.uiWidth != previous.uiWidth || derived.resolutionHeight != previous.resolutionHeight)) {
+        Resolution::table_t table = Resolution::makeTable(derived.uiWidth, derived.resolutionHeight);
+        pendingPatches.add(resolutionTable, table.data(), sizeof(table));
+        LOG("Rewriting resolution table with {}x{} @ {:s}", derived.uiWidth, derived.resolutionHeight, strBaseModule);
+    }
+
+    for (auto& [module, plan] : hookPlans) {
+        for (auto& entry : plan.entries) {
+            if (std::strcmp(entry.fix, "aspectRatioFix") != 0) {
+                continue;
             }
-        } else {
-            LOG("Failed to enumerate modules.");
+            const uint8_t* begin = reinterpret_cast<const uint8_t*>(&yml.resolution.aspectRatio);
+            entry.patch.assign(begin, begin + sizeof(float));
+            if (loaded && module == strBaseModule) {
+                pendingPatches.add((uintptr_t)baseModule + entry.rva, entry.patch.data(), entry.patch.size());
+            }
+        }
+    }
+    commitPatches();
+
+    for (size_t i = 0; i < fixRegistry.size(); ++i) {
+        if (fixRegistry[i]->enabled() != wasEnabled[i]) {
+            LOG("{} is now {}, dropping {} hook plans", fixRegistry[i]->name, wasEnabled[i] ? "disabled" : "enabled", hookPlans.size());
+            hookPlans.clear();
+            break;
         }
     }
+    LOG("Configuration reloaded");
+}
+
+/**
+ * @brief Wait for a game DLL from the `gameDllTable` to load.
+ * @details Sleeps on the module watcher until the loader reports that one of the game DLL's
+ * has been mapped, there is no polling involved so no CPU time is spent while waiting. Changes
+ * to the YAML file are applied while waiting. A game DLL that loaded before the previous one
+ * unloaded was kept aside by `waitForGameDllUnload` and is picked up first.
+ *
+ * @return void
+ */
+void waitForGameDllLoad() {
+    while(1) {
+        Watcher::event_t event;
+        if (!pendingLoads.empty()) {
+            event = pendingLoads.front();
+            pendingLoads.pop_front();
+        }
+        else {
+            event = Watcher::wait();
+        }
+        if (event.reason == Watcher::Reason::Loaded) {
+            baseModule = event.module;
+            strBaseModule = gameDllTable[event.index];
+            baseModuleIndex = event.index;
+#ifdef HOOK_TELEMETRY
+            Telemetry::setModule((uint32_t)event.index);
+#endif
+            LOG("{} Loaded", strBaseModule);
+            return;
+        }
+        if (event.reason == Watcher::Reason::Notified) {
+            reloadConfig(false);
+        }
+        Watcher::release(event);
+    }
 }
 
 /**
  * @brief Wait for the current game DLL to unload.
+ * @details Sleeps on the module watcher until the loader reports that the current game DLL
+ * is being unloaded, then destroys all hooks owned by it while it is still mapped before
+ * letting the loader unmap it. If the loader gave up waiting before the unload was claimed the
+ * module may already be gone, its hooks are then abandoned instead of restored. Changes to the
+ * YAML file are applied while waiting.
+ *
+ * The game may map the next game DLL before it unmaps the current one, so loads of other game
+ * DLL's are kept for the next `waitForGameDllLoad` instead of being thrown away. One that unloads
+ * again before it was picked up is forgotten.
  *
  * @return void
  */
 void waitForGameDllUnload() {
     while(1) {
-        HMODULE hModule = GetModuleHandle(strBaseModule.c_str());
-        if (hModule == NULL) {
-            LOG("{} Dropped", strBaseModule);
+        Watcher::event_t event = Watcher::wait();
+        if (event.reason == Watcher::Reason::Loaded && event.module != baseModule) {
+            pendingLoads.push_back(event);
+            continue;
+        }
+        if (event.reason == Watcher::Reason::Unloaded && event.module != baseModule) {
+            std::erase_if(pendingLoads, [&](const Watcher::event_t& pending) {
+                return pending.module == event.module;
+            });
+        }
+        if (event.reason == Watcher::Reason::Unloaded && event.module == baseModule) {
+            // Claimed first so the loader keeps the module mapped for as long as this takes
+            bool held = Watcher::claim(event);
+            resolutionTables[baseModuleIndex].store(0, std::memory_order_release);
+#ifdef HOOK_METRICS
+            Metrics::dump(strBaseModule.c_str());
+#endif
+            size_t released = held ? Hooks::release(baseModule) : Hooks::abandon(baseModule);
+#ifdef HOOK_CAPTURE
+            Capture::save("HackGULastRecodeFix.capture");
+#endif
+#ifdef HOOK_TELEMETRY
+            Telemetry::setModule(Telemetry::NO_MODULE);
+#endif
+            Watcher::release(event);
+            if (held) {
+                LOG("{} Dropped, released {} hooks", strBaseModule, released);
+            }
+            else {
+                LOG("{} was let go by the loader after {}ms and may be unmapped, abandoned {} hooks without restoring them",
+                    strBaseModule, Watcher::RELEASE_TIMEOUT, released);
+            }
             return;
         }
+        if (event.reason == Watcher::Reason::Notified) {
+            reloadConfig(true);
+        }
+        Watcher::release(event);
     }
 }
 
@@ -903,17 +1582,40 @@ void waitForGameDllUnload() {
  */
 DWORD __stdcall Main(void* lpParameter) {
     logInit();
-    readYml();
+    if (!readYml(&yml)) {
+        LOG("Using the default configuration");
+    }
+    logConfigure();
+    deriveConstants();
+    applyToggles();
+    Cache::load("HackGULastRecodeFix.cache");
+    if (!Watcher::init(gameDllTable, resolutionTableFix)) {
+        LOG("Failed to register module watcher");
+        return false;
+    }
+    if (!Watcher::watchFile("HackGULastRecodeFix.yml")) {
+        LOG("Failed to watch the YAML file, changes need a restart of the game");
+    }
+    if (!Display::start(displayChanged)) {
+        LOG("Failed to watch the displays, display changes need a restart of the game");
+    }
+#ifdef HOOK_METRICS
+    Metrics::start(HOOK_METRICS_INTERVAL);
+#endif
+#ifdef HOOK_TELEMETRY
+    Telemetry::setResolution(yml.resolution.width, yml.resolution.height);
+    if (!Telemetry::start("HackGULastRecodeFix.csv", gameDllTable, HOOK_TELEMETRY_INTERVAL)) {
+        LOG("Failed to start telemetry");
+    }
+#endif
     while(1) {
         waitForGameDllLoad();
-        constrainAntiAliasing();
-        viewportFix();
-        aspectRatioFix();
-        centerUiFix();
-        uiElementsFix();
-        combatOverlayFix();
-        textBubblePlacementFix();
-        cutsceneFix();
+        if (!Hooks::reserve(baseModule)) {
+            LOG("Failed to reserve hook memory near {:s}, hooks are placed wherever there is room", strBaseModule);
+        }
+        if (!replayHookPlan()) {
+            resolveFixes();
+        }
         waitForGameDllUnload();
     }
     return true;
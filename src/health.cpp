@@ -0,0 +1,118 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <format>
+#include <cstdint>
+
+#include "health.hpp"
+
+namespace
+{
+    // JSON of the last report of every game DLL, keyed by game DLL name
+    std::map<std::string, std::string> reports;
+
+    /**
+     * @brief Write a string as a JSON string
+     * @details Names and signatures are plain ASCII, only quotes and backslashes need escaping.
+     */
+    void appendString(std::string* out, const char* text) {
+        out->push_back('"');
+        for (const char* c = text; *c != '\0'; ++c) {
+            if (*c == '"' || *c == '\\') {
+                out->push_back('\\');
+            }
+            out->push_back(*c);
+        }
+        out->push_back('"');
+    }
+
+    std::string toJson(const Health::report_t& report) {
+        std::string out;
+        out += std::format("{{\"timeDateStamp\":\"0x{:08x}\",\"checkSum\":\"0x{:08x}\",\"sizeOfImage\":\"0x{:08x}\",\"scanMicroseconds\":{},\"fixes\":[",
+            report.identity.timeDateStamp,
+            report.identity.checkSum,
+            report.identity.sizeOfImage,
+            report.scanMicroseconds
+        );
+        for (size_t i = 0; i < report.fixes.size(); ++i) {
+            const Health::fix_t& fix = report.fixes[i];
+            out += i > 0 ? ",{\"name\":" : "{\"name\":";
+            appendString(&out, fix.name);
+            out += std::format(",\"status\":\"{}\"", Health::toString(fix.status));
+            if (fix.status == Health::Status::Resolved || fix.status == Health::Status::Fallback ||
+                fix.status == Health::Status::Ambiguous) {
+                out += std::format(",\"signature\":{},\"rva\":\"0x{:x}\"", fix.signature, fix.rva);
+            }
+            out += ",\"signatures\":[";
+            for (size_t j = 0; j < fix.signatures.size(); ++j) {
+                const Health::signature_t& signature = fix.signatures[j];
+                out += j > 0 ? ",{\"pattern\":" : "{\"pattern\":";
+                appendString(&out, signature.text);
+                out += std::format(",\"hits\":{},\"cached\":{}}}", signature.hits, signature.cached);
+            }
+            out += "]}";
+        }
+        out += "]}";
+        return out;
+    }
+}
+
+namespace Health
+{
+    const char* toString(Status status) {
+        switch (status) {
+            case Status::Resolved:  return "resolved";
+            case Status::Fallback:  return "fallback";
+            case Status::Ambiguous: return "ambiguous";
+            case Status::Missing:   return "missing";
+            case Status::Disabled:  return "disabled";
+            case Status::Unused:    return "unused";
+        }
+        return "unknown";
+    }
+
+    bool save(const std::string& path, const report_t& report) {
+        reports[report.identity.module] = toJson(report);
+
+        std::string out = "{\n";
+        size_t i = 0;
+        for (const auto& [module, json] : reports) {
+            out += "  ";
+            appendString(&out, module.c_str());
+            out += ":";
+            out += json;
+            out += ++i < reports.size() ? ",\n" : "\n";
+        }
+        out += "}\n";
+
+        std::ofstream file(path, std::ios::trunc);
+        file << out;
+        return file.good();
+    }
+}
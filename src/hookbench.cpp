@@ -0,0 +1,316 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/**
+ * @file hookbench.cpp
+ * @brief Hack GU Last Recode hook callback benchmark
+ *
+ * @details
+ * Replays hook contexts recorded in the game by a `HOOK_CAPTURE` build through the callbacks in
+ * `Callbacks::sites`. The game memory a callback touches is replayed from the recording too, the
+ * register its window is addressed through is pointed at a copy of the recorded window.
+ *
+ * Every recorded sample is first replayed once and its registers, window and text bubble state
+ * after the callback are compared bit for bit with what was recorded in the game, any difference
+ * fails the benchmark. Each sample is replayed with the fix switches of `Callbacks::toggles` it
+ * was recorded with, the timing runs use the switches of the first sample of a callback. A digest of all outputs is printed as well. Every callback is then called
+ * over its samples, over and over until `--calls` calls were made, and the cycles per call are
+ * reported with the cost of calling an empty callback the same way taken off. The samples are
+ * restored between passes outside of the measured time.
+ *
+ * Usage:
+ *   HackGULastRecodeHookBench [--calls N] [capture file]
+ *
+ *   The capture file defaults to HackGULastRecodeFix.capture.
+ */
+
+// System includes
+#include <iostream>
+#include <fstream>
+#include <format>
+#include <string>
+#include <vector>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+// 3rd party includes
+#include "safetyhook.hpp"
+
+// Local includes
+#include "callbacks.hpp"
+#include "capture.hpp"
+
+// Macros
+#define LOG(STRING, ...) std::cout << std::format(STRING "\n", ##__VA_ARGS__)
+
+/**
+ * @brief A recorded sample ready to be replayed.
+ *
+ */
+typedef struct replay_t {
+    SafetyHookContext ctx;
+    alignas(16) uint8_t window[Callbacks::MAX_WINDOW];
+} replay_t;
+
+/**
+ * @brief Reads a capture file.
+ *
+ * @param path Path of the capture file
+ * @param header Header of the file
+ * @param samples Samples of the file
+ * @return true if the file was read and was written by a matching build, false otherwise
+ */
+bool loadCapture(const std::string& path, Capture::header_t* header, std::vector<Capture::sample_t>* samples) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.read(reinterpret_cast<char*>(header), sizeof(*header))) {
+        LOG("Failed to read {}", path);
+        return false;
+    }
+    if (header->magic != Capture::FILE_MAGIC || header->version != Capture::FILE_VERSION ||
+        header->sampleSize != sizeof(Capture::sample_t)) {
+        LOG("{} was not written by a matching build", path);
+        return false;
+    }
+    samples->resize(header->count);
+    if (!file.read(reinterpret_cast<char*>(samples->data()), samples->size() * sizeof(Capture::sample_t))) {
+        LOG("{} is truncated", path);
+        return false;
+    }
+    for (const auto& sample : *samples) {
+        if (sample.site >= Callbacks::sites.size()) {
+            LOG("{} has a sample of unknown site {}", path, sample.site);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Sets up a sample for replay, the window register is pointed at the copy of the window.
+ *
+ * @param sample Recorded sample
+ * @param replay Replay to set up
+ * @return void
+ */
+void prepare(const Capture::sample_t& sample, replay_t* replay) {
+    const Callbacks::window_t& window = Callbacks::sites[sample.site].window;
+    replay->ctx = sample.before;
+    std::memcpy(replay->window, sample.windowBefore, sizeof(replay->window));
+    if (window.reg != nullptr) {
+        replay->ctx.*window.reg = (uintptr_t)replay->window - window.displacement;
+    }
+}
+
+/**
+ * @brief Folds bytes into a 64 bit FNV-1a digest.
+ *
+ * @param digest Digest to fold into
+ * @param data Bytes
+ * @param size Number of bytes
+ * @return uint64_t
+ */
+uint64_t fold(uint64_t digest, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        digest = (digest ^ bytes[i]) * 0x100000001B3ull;
+    }
+    return digest;
+}
+
+/**
+ * @brief Replays every sample once and compares the outputs with the recorded ones.
+ *
+ * @param samples Recorded samples
+ * @return true if every output is identical
+ */
+bool verify(const std::vector<Capture::sample_t>& samples) {
+    std::array<size_t, Callbacks::sites.size()> counts = {};
+    std::array<size_t, Callbacks::sites.size()> mismatches = {};
+    uint64_t digest = 0xCBF29CE484222325ull;
+    for (const auto& sample : samples) {
+        const Callbacks::site_t& site = Callbacks::sites[sample.site];
+        replay_t replay;
+        prepare(sample, &replay);
+        Callbacks::textBubbleScaler.store(sample.scalerBefore);
+        Capture::restoreToggles(sample.toggles);
+        site.callback(replay.ctx);
+        if (site.window.reg != nullptr) {
+            replay.ctx.*site.window.reg = sample.before.*site.window.reg;
+        }
+
+        Callbacks::textBubbleScaler_t scaler = Callbacks::textBubbleScaler.load();
+        bool same = std::memcmp(&replay.ctx, &sample.after, sizeof(SafetyHookContext)) == 0 &&
+            std::memcmp(&scaler, &sample.scalerAfter, sizeof(Callbacks::textBubbleScaler_t)) == 0 &&
+            (!sample.windowValid || std::memcmp(replay.window, sample.windowAfter, site.window.size) == 0);
+        counts[sample.site]++;
+        mismatches[sample.site] += !same;
+        digest = fold(digest, &replay.ctx, sizeof(SafetyHookContext));
+        digest = fold(digest, replay.window, site.window.size);
+        digest = fold(digest, &scaler, sizeof(Callbacks::textBubbleScaler_t));
+    }
+
+    bool identical = true;
+    for (size_t i = 0; i < Callbacks::sites.size(); ++i) {
+        if (counts[i] > 0) {
+            LOG("  {:<24} {:>6} samples {:>6} mismatches", Callbacks::sites[i].name, counts[i], mismatches[i]);
+        }
+        identical = identical && mismatches[i] == 0;
+    }
+    LOG("  Output digest {:016x}", digest);
+    return identical;
+}
+
+/**
+ * @brief Callback that does nothing, used to measure the cost of the replay loop itself.
+ *
+ * @param ctx Unused
+ * @return void
+ */
+void empty(SafetyHookContext& ctx) {
+}
+
+/**
+ * @brief Calls a callback over a set of replays until `calls` calls were made.
+ *
+ * @param callback Callback to call
+ * @param pristine Replays as prepared, copied over `working` before every pass
+ * @param working Replays the callback runs on
+ * @param calls Minimum number of calls
+ * @param made Number of calls actually made
+ * @param seconds Wall time spent in the calls
+ * @return uint64_t Cycles spent in the calls
+ */
+uint64_t run(safetyhook::MidHookFn callback, const std::vector<replay_t>& pristine, std::vector<replay_t>& working, size_t calls, size_t* made, double* seconds) {
+    // Called through a volatile pointer so the call stays indirect like it is from a hook
+    safetyhook::MidHookFn volatile target = callback;
+    uint64_t cycles = 0;
+    *made = 0;
+    *seconds = 0;
+    while (*made < calls) {
+        working = pristine;
+        auto begin = std::chrono::steady_clock::now();
+        uint64_t start = __rdtsc();
+        for (auto& replay : working) {
+            target(replay.ctx);
+        }
+        cycles += __rdtsc() - start;
+        *seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        *made += working.size();
+    }
+    return cycles;
+}
+
+/**
+ * @brief Measures the cycles per call of every callback that has samples.
+ *
+ * @param samples Recorded samples
+ * @param calls Number of calls per callback
+ * @return void
+ */
+void measure(const std::vector<Capture::sample_t>& samples, size_t calls) {
+    for (size_t i = 0; i < Callbacks::sites.size(); ++i) {
+        const Callbacks::site_t& site = Callbacks::sites[i];
+        std::vector<const Capture::sample_t*> recorded;
+        for (const auto& sample : samples) {
+            if (sample.site == i) {
+                recorded.push_back(&sample);
+            }
+        }
+        if (recorded.empty()) {
+            continue;
+        }
+
+        // The window pointers are taken from `working`, which is never reallocated
+        std::vector<replay_t> working(recorded.size());
+        for (size_t j = 0; j < recorded.size(); ++j) {
+            prepare(*recorded[j], &working[j]);
+        }
+        std::vector<replay_t> pristine = working;
+        Callbacks::textBubbleScaler.store(recorded[0]->scalerBefore);
+        Capture::restoreToggles(recorded[0]->toggles);
+
+        size_t made = 0;
+        size_t baselineMade = 0;
+        double seconds = 0;
+        double baselineSeconds = 0;
+        uint64_t cycles = run(site.callback, pristine, working, calls, &made, &seconds);
+        uint64_t baseline = run(empty, pristine, working, calls, &baselineMade, &baselineSeconds);
+
+        double perCall = (double)cycles / (double)made - (double)baseline / (double)baselineMade;
+        double nsPerCall = (seconds / (double)made - baselineSeconds / (double)baselineMade) * 1e9;
+        LOG("  {:<24} {:>10} calls {:>8.2f} cycles/call {:>8.2f} ns/call",
+            site.name,
+            made,
+            perCall > 0 ? perCall : 0.0,
+            nsPerCall > 0 ? nsPerCall : 0.0
+        );
+    }
+}
+
+/**
+ * @brief Entry point of the benchmark.
+ *
+ * @param argc Number of arguments
+ * @param argv Arguments, see the usage above
+ * @return 0 if every replayed output matched the recording, 1 otherwise
+ */
+int main(int argc, char** argv) {
+    size_t calls = 10000000;
+    std::string path = "HackGULastRecodeFix.capture";
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--calls" && i + 1 < argc) {
+            calls = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else {
+            path = argument;
+        }
+    }
+
+    Capture::header_t header;
+    std::vector<Capture::sample_t> samples;
+    if (!loadCapture(path, &header, &samples)) {
+        return 1;
+    }
+    Callbacks::publishDerived(header.derived);
+    LOG("{}: {} samples", path, samples.size());
+
+    LOG("Verifying");
+    bool identical = verify(samples);
+    LOG("Measuring");
+    measure(samples, calls);
+
+    LOG("{}", identical ? "All outputs identical to the recording" : "Outputs differ from the recording");
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <string_view>
+#include <cstring>
+
+#include "spdlog/spdlog.h"
+
+#include "hooklog.hpp"
+
+namespace
+{
+    constexpr size_t RINGS = 16;
+    constexpr size_t RING_LINES = 64;
+
+    typedef struct line_t {
+        size_t size;
+        char text[HookLog::LINE_SIZE];
+    } line_t;
+
+    // Single producer, the thread that claimed it, and single consumer, the drain thread
+    typedef struct ring_t {
+        std::atomic<bool> claimed;
+        std::atomic<uint32_t> dropped;
+        alignas(64) std::atomic<uint32_t> head;
+        alignas(64) std::atomic<uint32_t> tail;
+        line_t lines[RING_LINES];
+    } ring_t;
+
+    ring_t pool[RINGS];
+    std::atomic<uint32_t> poolDropped;
+
+    // A claimed ring is never given back, the game threads that run hooks live as long as the game
+    thread_local ring_t* ring = nullptr;
+    thread_local bool exhausted = false;
+
+    ring_t* claim() {
+        for (ring_t& candidate : pool) {
+            bool expected = false;
+            if (candidate.claimed.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return &candidate;
+            }
+        }
+        return nullptr;
+    }
+
+    void drain() {
+        static uint32_t reported[RINGS] = {};
+        static uint32_t poolReported = 0;
+        for (size_t i = 0; i < RINGS; i++) {
+            ring_t& current = pool[i];
+            if (!current.claimed.load(std::memory_order_acquire)) {
+                continue;
+            }
+            uint32_t tail = current.tail.load(std::memory_order_relaxed);
+            uint32_t head = current.head.load(std::memory_order_acquire);
+            while (tail != head) {
+                const line_t& line = current.lines[tail % RING_LINES];
+                spdlog::info("{}", std::string_view(line.text, line.size));
+                tail++;
+            }
+            current.tail.store(tail, std::memory_order_release);
+            uint32_t dropped = current.dropped.load(std::memory_order_relaxed);
+            if (dropped != reported[i]) {
+                spdlog::warn("HookLog : Ring {} full, dropped {} lines", i, dropped - reported[i]);
+                reported[i] = dropped;
+            }
+        }
+        uint32_t dropped = poolDropped.load(std::memory_order_relaxed);
+        if (dropped != poolReported) {
+            spdlog::warn("HookLog : No ring left, dropped {} lines", dropped - poolReported);
+            poolReported = dropped;
+        }
+    }
+}
+
+namespace HookLog
+{
+    bool allow(limiter_t* limiter, uint32_t* suppressed) {
+        int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+        int64_t next = limiter->next.load(std::memory_order_relaxed);
+        if (now < next || !limiter->next.compare_exchange_strong(next,
+                now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(RATE_LIMIT).count(),
+                std::memory_order_relaxed)) {
+            limiter->suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        *suppressed = limiter->suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+    void push(const char* line, size_t size) {
+        if (ring == nullptr) {
+            if (!exhausted) {
+                ring = claim();
+                exhausted = ring == nullptr;
+            }
+            if (ring == nullptr) {
+                poolDropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        uint32_t head = ring->head.load(std::memory_order_relaxed);
+        uint32_t tail = ring->tail.load(std::memory_order_acquire);
+        if (head - tail == RING_LINES) {
+            ring->dropped.store(ring->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        line_t& slot = ring->lines[head % RING_LINES];
+        slot.size = size < LINE_SIZE ? size : LINE_SIZE;
+        std::memcpy(slot.text, line, slot.size);
+        ring->head.store(head + 1, std::memory_order_release);
+    }
+
+    void start(std::chrono::milliseconds interval) {
+        std::thread([interval]() {
+            while (1) {
+                std::this_thread::sleep_for(interval);
+                drain();
+            }
+        }).detach();
+    }
+}
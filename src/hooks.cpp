@@ -0,0 +1,129 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <windows.h>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <memory>
+
+#include "safetyhook.hpp"
+
+#include "hooks.hpp"
+
+namespace
+{
+    typedef struct stubHook_t {
+        // Declared first so it is destroyed last, after the hook stops jumping into it
+        safetyhook::Allocation code;
+        // Only set for guarded stubs, sits inside `code`
+        SafetyMidHook midHook;
+        SafetyHookInline hook;
+    } stubHook_t;
+
+    typedef struct owned_t {
+        // Declared first so it is dropped last, after every hook that allocated from it
+        std::shared_ptr<safetyhook::Allocator> arena;
+        std::vector<SafetyMidHook> midHooks;
+        std::vector<stubHook_t> stubHooks;
+    } owned_t;
+
+    std::mutex registryMutex;
+    std::map<HMODULE, owned_t> registry;
+}
+
+namespace Hooks
+{
+    bool reserve(HMODULE owner) {
+        std::shared_ptr<safetyhook::Allocator> allocator = arena(owner);
+        // The block stays with the arena after the allocation is freed, later ones reuse it
+        auto allocation = allocator->allocate_near({ (uint8_t*)owner }, 1);
+        return allocation.has_value();
+    }
+
+    std::shared_ptr<safetyhook::Allocator> arena(HMODULE owner) {
+        std::scoped_lock lock(registryMutex);
+        owned_t& owned = registry[owner];
+        if (owned.arena == nullptr) {
+            owned.arena = safetyhook::Allocator::create();
+        }
+        return owned.arena;
+    }
+
+    void add(HMODULE owner, SafetyMidHook&& hook) {
+        std::scoped_lock lock(registryMutex);
+        registry[owner].midHooks.push_back(std::move(hook));
+    }
+
+    void add(HMODULE owner, SafetyHookInline&& hook, safetyhook::Allocation&& code) {
+        std::scoped_lock lock(registryMutex);
+        registry[owner].stubHooks.push_back({ std::move(code), {}, std::move(hook) });
+    }
+
+    void add(HMODULE owner, SafetyHookInline&& hook, SafetyMidHook&& midHook, safetyhook::Allocation&& code) {
+        std::scoped_lock lock(registryMutex);
+        registry[owner].stubHooks.push_back({ std::move(code), std::move(midHook), std::move(hook) });
+    }
+
+    size_t release(HMODULE owner) {
+        owned_t hooks;
+        {
+            std::scoped_lock lock(registryMutex);
+            auto entry = registry.find(owner);
+            if (entry == registry.end()) {
+                return 0;
+            }
+            hooks = std::move(entry->second);
+            registry.erase(entry);
+        }
+        size_t released = hooks.midHooks.size() + hooks.stubHooks.size();
+        hooks.midHooks.clear();
+        hooks.stubHooks.clear();
+        hooks.arena.reset();
+        return released;
+    }
+
+    size_t abandon(HMODULE owner) {
+        owned_t* hooks = new owned_t;
+        {
+            std::scoped_lock lock(registryMutex);
+            auto entry = registry.find(owner);
+            if (entry == registry.end()) {
+                delete hooks;
+                return 0;
+            }
+            *hooks = std::move(entry->second);
+            registry.erase(entry);
+        }
+        // Never freed, destroying the hooks would write the original bytes back
+        return hooks->midHooks.size() + hooks->stubHooks.size();
+    }
+
+    size_t count(HMODULE owner) {
+        std::scoped_lock lock(registryMutex);
+        auto entry = registry.find(owner);
+        return entry == registry.end() ? 0 : entry->second.midHooks.size() + entry->second.stubHooks.size();
+    }
+}
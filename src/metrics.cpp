@@ -0,0 +1,251 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include <atomic>
+#include <array>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <utility>
+#include <bit>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+#include "spdlog/spdlog.h"
+#include "safetyhook.hpp"
+
+#include "metrics.hpp"
+
+namespace
+{
+    // Bucket b counts calls that took less than 2^b cycles, the last bucket takes everything above
+    constexpr size_t BUCKETS = 40;
+
+    typedef struct siteStats_t {
+        std::atomic<uint64_t> calls;
+        std::atomic<uint64_t> cycles;
+        std::atomic<uint64_t> guards;
+        std::atomic<uint64_t> guardHits;
+        std::atomic<uint64_t> histogram[BUCKETS];
+    } siteStats_t;
+
+    typedef struct threadStats_t {
+        siteStats_t sites[Metrics::MAX_SITES];
+        // Cycles of all sites on this thread
+        std::atomic<uint64_t> cycles;
+    } threadStats_t;
+
+    // Threads whose counters `totalCycles` sums up without the lock, a thread past the end is
+    // only part of the summaries
+    constexpr size_t MAX_THREADS = 256;
+
+    typedef struct site_t {
+        std::string name;
+        safetyhook::MidHookFn hook;
+        // Totals at the previous summary
+        uint64_t calls;
+        uint64_t guards;
+        uint64_t guardHits;
+        uint64_t histogram[BUCKETS];
+    } site_t;
+
+    std::mutex metricsMutex;
+    std::vector<site_t> sites;
+    // Never freed, a thread that exits leaves its counters behind so they still add up
+    std::vector<threadStats_t*> threads;
+    std::chrono::steady_clock::time_point lastDump = std::chrono::steady_clock::now();
+
+    // Written before the hook calling into the site is created
+    safetyhook::MidHookFn callbacks[Metrics::MAX_SITES];
+
+    // Append only, a slot is written before `publishedThreads` is raised past it
+    std::atomic<threadStats_t*> publishedStats[MAX_THREADS];
+    std::atomic<size_t> publishedThreads = 0;
+
+    thread_local threadStats_t* stats = nullptr;
+    thread_local size_t current = Metrics::MAX_SITES;
+
+    // Each counter has a single writer, so a plain load and store is enough and avoids a lock prefix
+    inline void bump(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    threadStats_t* threadStats() {
+        if (stats == nullptr) {
+            stats = new threadStats_t{};
+            std::scoped_lock lock(metricsMutex);
+            threads.push_back(stats);
+            size_t slot = publishedThreads.load(std::memory_order_relaxed);
+            if (slot < MAX_THREADS) {
+                publishedStats[slot].store(stats, std::memory_order_relaxed);
+                publishedThreads.store(slot + 1, std::memory_order_release);
+            }
+        }
+        return stats;
+    }
+
+    template <size_t N>
+    void thunk(SafetyHookContext& ctx) {
+        threadStats_t* local = threadStats();
+        current = N;
+        uint64_t start = __rdtsc();
+        callbacks[N](ctx);
+        uint64_t cycles = __rdtsc() - start;
+        current = Metrics::MAX_SITES;
+        size_t bucket = std::bit_width(cycles);
+        siteStats_t& site = local->sites[N];
+        bump(site.calls);
+        site.cycles.store(site.cycles.load(std::memory_order_relaxed) + cycles, std::memory_order_relaxed);
+        local->cycles.store(local->cycles.load(std::memory_order_relaxed) + cycles, std::memory_order_relaxed);
+        bump(site.histogram[bucket < BUCKETS ? bucket : BUCKETS - 1]);
+    }
+
+    template <size_t... N>
+    constexpr std::array<safetyhook::MidHookFn, sizeof...(N)> makeThunks(std::index_sequence<N...>) {
+        return { &thunk<N>... };
+    }
+
+    constexpr std::array<safetyhook::MidHookFn, Metrics::MAX_SITES> thunks =
+        makeThunks(std::make_index_sequence<Metrics::MAX_SITES>{});
+
+    uint64_t percentile(const uint64_t* histogram, uint64_t total, double fraction) {
+        uint64_t rank = (uint64_t)(total * fraction);
+        uint64_t seen = 0;
+        for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+            seen += histogram[bucket];
+            if (seen > rank) {
+                return 1ull << bucket;
+            }
+        }
+        return 1ull << (BUCKETS - 1);
+    }
+}
+
+namespace Metrics
+{
+    safetyhook::MidHookFn wrap(const char* name, safetyhook::MidHookFn hook) {
+        std::scoped_lock lock(metricsMutex);
+        for (size_t i = 0; i < sites.size(); i++) {
+            if (sites[i].hook == hook && sites[i].name == name) {
+                return thunks[i];
+            }
+        }
+        if (sites.size() == MAX_SITES) {
+            spdlog::info("Metrics : No site left for {}, it will not be measured", name);
+            return hook;
+        }
+        size_t id = sites.size();
+        callbacks[id] = hook;
+        site_t site = {};
+        site.name = name;
+        site.hook = hook;
+        sites.push_back(site);
+        return thunks[id];
+    }
+
+    bool guard(bool taken) {
+        if (current < MAX_SITES) {
+            siteStats_t& site = stats->sites[current];
+            bump(site.guards);
+            if (taken) {
+                bump(site.guardHits);
+            }
+        }
+        return taken;
+    }
+
+    void dump(const char* reason) {
+        std::scoped_lock lock(metricsMutex);
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(now - lastDump).count();
+        lastDump = now;
+        spdlog::info("Metrics : {} summary over {:.1f}s", reason, seconds);
+        for (size_t i = 0; i < sites.size(); i++) {
+            site_t& site = sites[i];
+            uint64_t calls = 0;
+            uint64_t guards = 0;
+            uint64_t guardHits = 0;
+            uint64_t histogram[BUCKETS] = {};
+            for (threadStats_t* thread : threads) {
+                siteStats_t& local = thread->sites[i];
+                calls += local.calls.load(std::memory_order_relaxed);
+                guards += local.guards.load(std::memory_order_relaxed);
+                guardHits += local.guardHits.load(std::memory_order_relaxed);
+                for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+                    histogram[bucket] += local.histogram[bucket].load(std::memory_order_relaxed);
+                }
+            }
+            uint64_t deltaCalls = calls - site.calls;
+            uint64_t deltaGuards = guards - site.guards;
+            uint64_t deltaGuardHits = guardHits - site.guardHits;
+            for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+                uint64_t total = histogram[bucket];
+                histogram[bucket] -= site.histogram[bucket];
+                site.histogram[bucket] = total;
+            }
+            site.calls = calls;
+            site.guards = guards;
+            site.guardHits = guardHits;
+            if (deltaCalls == 0) {
+                continue;
+            }
+            uint64_t p50 = percentile(histogram, deltaCalls, 0.50);
+            uint64_t p99 = percentile(histogram, deltaCalls, 0.99);
+            double rate = seconds > 0 ? deltaCalls / seconds : 0;
+            if (deltaGuards > 0) {
+                spdlog::info("Metrics : {:<40} {:>12.0f} calls/s p50 <{} p99 <{} cycles, guard hit {:.1f}%",
+                    site.name, rate, p50, p99, 100.0 * deltaGuardHits / deltaGuards);
+            }
+            else {
+                spdlog::info("Metrics : {:<40} {:>12.0f} calls/s p50 <{} p99 <{} cycles",
+                    site.name, rate, p50, p99);
+            }
+        }
+    }
+
+    uint64_t totalCycles() {
+        size_t count = publishedThreads.load(std::memory_order_acquire);
+        uint64_t total = 0;
+        for (size_t i = 0; i < count; i++) {
+            total += publishedStats[i].load(std::memory_order_relaxed)->cycles.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    void start(uint32_t intervalSeconds) {
+        std::thread([intervalSeconds]() {
+            while (1) {
+                std::this_thread::sleep_for(std::chrono::seconds(intervalSeconds));
+                dump("Periodic");
+            }
+        }).detach();
+    }
+}
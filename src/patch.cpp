@@ -0,0 +1,172 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include <windows.h>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+#include "patch.hpp"
+
+namespace
+{
+    typedef struct run_t {
+        uintptr_t begin;
+        uintptr_t end;
+    } run_t;
+
+    typedef struct protection_t {
+        uintptr_t begin;
+        size_t size;
+        DWORD old;
+    } protection_t;
+
+    size_t pageSize() {
+        static const size_t size = []() {
+            SYSTEM_INFO info;
+            GetSystemInfo(&info);
+            return static_cast<size_t>(info.dwPageSize);
+        }();
+        return size;
+    }
+
+    bool isWritable(DWORD protect) {
+        return (protect & (PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY)) != 0;
+    }
+
+    bool isExecutable(DWORD protect) {
+        return (protect & (PAGE_EXECUTE | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY)) != 0;
+    }
+}
+
+namespace Patch
+{
+    void Transaction::add(uintptr_t address, const void* bytes, size_t size) {
+        edit_t& edit = m_edits.emplace_back();
+        edit.address = address;
+        edit.size = size;
+        if (size > INLINE_SIZE) {
+            edit.heap.resize(size * 2);
+        }
+        memcpy(edit.bytes(), bytes, size);
+        m_committed = false;
+    }
+
+    bool Transaction::commit() {
+        if (m_committed) {
+            return true;
+        }
+        std::stable_sort(m_edits.begin(), m_edits.end(), [](const edit_t& a, const edit_t& b) {
+            return a.address < b.address;
+        });
+        m_committed = write(false);
+        return m_committed;
+    }
+
+    bool Transaction::rollback() {
+        if (!m_committed) {
+            return false;
+        }
+        m_committed = !write(true);
+        return !m_committed;
+    }
+
+    bool Transaction::write(bool original) {
+        if (m_edits.empty()) {
+            return true;
+        }
+
+        // Edits are sorted so touching or overlapping page ranges merge into a single run
+        std::vector<run_t> runs;
+        uintptr_t mask = ~(static_cast<uintptr_t>(pageSize()) - 1);
+        for (const edit_t& edit : m_edits) {
+            uintptr_t begin = edit.address & mask;
+            uintptr_t end = (edit.address + edit.size + pageSize() - 1) & mask;
+            if (!runs.empty() && begin <= runs.back().end) {
+                runs.back().end = end > runs.back().end ? end : runs.back().end;
+            }
+            else {
+                runs.push_back({ begin, end });
+            }
+        }
+
+        // A run can span pages with different protections, so it is split where they change
+        std::vector<protection_t> changed;
+        bool ok = true;
+        for (const run_t& run : runs) {
+            for (uintptr_t current = run.begin; ok && current < run.end; ) {
+                MEMORY_BASIC_INFORMATION mbi;
+                if (VirtualQuery(reinterpret_cast<void*>(current), &mbi, sizeof(mbi)) == 0 ||
+                    mbi.State != MEM_COMMIT || (mbi.Protect & (PAGE_GUARD | PAGE_NOACCESS)) != 0) {
+                    ok = false;
+                    break;
+                }
+                uintptr_t regionEnd = reinterpret_cast<uintptr_t>(mbi.BaseAddress) + mbi.RegionSize;
+                uintptr_t stop = regionEnd < run.end ? regionEnd : run.end;
+                if (!isWritable(mbi.Protect)) {
+                    DWORD protect = isExecutable(mbi.Protect) ? PAGE_EXECUTE_READWRITE : PAGE_READWRITE;
+                    DWORD old;
+                    if (!VirtualProtect(reinterpret_cast<void*>(current), stop - current, protect, &old)) {
+                        ok = false;
+                        break;
+                    }
+                    changed.push_back({ current, stop - current, old });
+                }
+                current = stop;
+            }
+        }
+
+        if (ok) {
+            if (original) {
+                // Backwards so overlapping edits are undone in reverse order
+                for (auto edit = m_edits.rbegin(); edit != m_edits.rend(); ++edit) {
+                    memcpy(reinterpret_cast<void*>(edit->address), edit->original(), edit->size);
+                }
+            }
+            else {
+                for (edit_t& edit : m_edits) {
+                    memcpy(edit.original(), reinterpret_cast<void*>(edit.address), edit.size);
+                    memcpy(reinterpret_cast<void*>(edit.address), edit.bytes(), edit.size);
+                }
+            }
+        }
+
+        for (const protection_t& protection : changed) {
+            DWORD old;
+            VirtualProtect(reinterpret_cast<void*>(protection.begin), protection.size, protection.old, &old);
+        }
+
+        if (ok) {
+            FlushInstructionCache(
+                GetCurrentProcess(),
+                reinterpret_cast<void*>(runs.front().begin),
+                runs.back().end - runs.front().begin
+            );
+        }
+        m_protectedRuns = changed.size();
+        return ok;
+    }
+}
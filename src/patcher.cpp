@@ -0,0 +1,423 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file patcher.cpp
+ * @brief Hack GU Last Recode resolution table patcher
+ *
+ * @details
+ * The game DLL's all feature a resolution table that the game indexes into very early on during
+ * initialization, this sets up the game window as well as various other calculations based off
+ * that resolution. This tool goes through each game DLL, finds the resolution table and replaces
+ * all of its entries with the resolution provided in the YAML file.
+ *
+ * Every DLL is memory mapped and patched in place through the mapping, nothing is read into
+ * memory up front. The table is found with the same scanner the fix uses, and all DLL's are
+ * processed in parallel. Where each table was found and what was written into it is recorded in
+ * a checksummed state file, so the next run, ie after the resolution was changed, finds the
+ * already patched table directly without having to know what it was patched with.
+ *
+ * Usage:
+ *   Place next to HackGULastRecodeFix.yml in the scripts folder of the game and run it after
+ *   changing the resolution in the YAML file. The game folder defaults to the parent folder and
+ *   can be given as the first argument instead.
+ */
+
+// System includes
+#include <windows.h>
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <format>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+// 3rd party includes
+#include "yaml-cpp/yaml.h"
+
+// Local includes
+#include "utils.hpp"
+#include "display.hpp"
+#include "scanner.hpp"
+#include "resolution.hpp"
+
+// Macros
+#define LOG(STRING, ...) std::cout << std::format(STRING "\n", ##__VA_ARGS__)
+
+/**
+ * @brief Where the table of a game DLL was found and what it was patched with.
+ *
+ */
+typedef struct record_t {
+    std::string dll;
+    uint64_t offset;
+    uint32_t width;
+    uint32_t height;
+} record_t;
+
+/**
+ * @brief Outcome of patching a single game DLL.
+ *
+ */
+typedef struct result_t {
+    bool ok;
+    record_t record;
+    std::string message;
+} result_t;
+
+/**
+ * @brief A game DLL mapped read write into memory.
+ *
+ */
+typedef struct mapping_t {
+    HANDLE file;
+    HANDLE mapping;
+    uint8_t* data;
+    size_t size;
+} mapping_t;
+
+const char* ymlFile = "HackGULastRecodeFix.yml";
+const char* stateFile = "HackGULastRecodePatch.state";
+// Written by the old Python patcher, only read to pick up tables it patched
+const char* legacyStateFile = "patch.txt";
+// Contents of the legacy state file, the signature parsed from it points into this
+std::string legacyTable;
+
+std::vector<std::string> gameDllTable = {
+    "hackGU_terminal.dll",
+    "hackGU_title.dll",
+    "hackGU_vol1.dll",
+    "hackGU_vol2.dll",
+    "hackGU_vol3.dll",
+    "hackGU_vol4.dll",
+};
+
+/**
+ * @brief CRC-32 of a string, used to detect a damaged or hand edited state file.
+ *
+ * @param data String to checksum
+ * @return uint32_t
+ */
+uint32_t crc32(const std::string& data) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (unsigned char c : data) {
+        crc ^= c;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Checksum over every record of a state file.
+ *
+ * @param records Records to checksum
+ * @return uint32_t
+ */
+uint32_t checksum(const std::vector<record_t>& records) {
+    std::string canonical;
+    for (const record_t& record : records) {
+        canonical += std::format("{}:{:x}:{}:{};", record.dll, record.offset, record.width, record.height);
+    }
+    return crc32(canonical);
+}
+
+/**
+ * @brief Reads the state file written by the previous run.
+ *
+ * @details
+ * A missing, unreadable or damaged state file, one whose checksum does not match its records,
+ * results in no records and every DLL is scanned for its table.
+ *
+ * @return std::vector<record_t>
+ */
+std::vector<record_t> readState() {
+    std::vector<record_t> records;
+    if (!std::filesystem::exists(stateFile)) {
+        return records;
+    }
+    try {
+        YAML::Node state = YAML::LoadFile(stateFile);
+        for (const auto& node : state["dlls"]) {
+            records.push_back({
+                node["dll"].as<std::string>(),
+                node["offset"].as<uint64_t>(),
+                node["width"].as<uint32_t>(),
+                node["height"].as<uint32_t>(),
+            });
+        }
+        if (state["checksum"].as<uint32_t>() != checksum(records)) {
+            LOG("{} is damaged, ignoring it", stateFile);
+            records.clear();
+        }
+    }
+    catch (const YAML::Exception& e) {
+        LOG("{} is unreadable, ignoring it: {}", stateFile, e.what());
+        records.clear();
+    }
+    return records;
+}
+
+/**
+ * @brief Writes the state file.
+ *
+ * @param records Records to write
+ * @return void
+ */
+void writeState(const std::vector<record_t>& records) {
+    YAML::Emitter out;
+    out << YAML::BeginMap;
+    out << YAML::Key << "dlls" << YAML::Value << YAML::BeginSeq;
+    for (const record_t& record : records) {
+        out << YAML::BeginMap;
+        out << YAML::Key << "dll" << YAML::Value << record.dll;
+        out << YAML::Key << "offset" << YAML::Value << record.offset;
+        out << YAML::Key << "width" << YAML::Value << record.width;
+        out << YAML::Key << "height" << YAML::Value << record.height;
+        out << YAML::EndMap;
+    }
+    out << YAML::EndSeq;
+    out << YAML::Key << "checksum" << YAML::Value << checksum(records);
+    out << YAML::EndMap;
+
+    std::ofstream file(stateFile, std::ios::trunc);
+    file << out.c_str() << "\n";
+}
+
+/**
+ * @brief Maps a file read write into memory.
+ *
+ * @param path File to map
+ * @param mapped Receives the mapping
+ * @return true on success
+ */
+bool mapFile(const std::filesystem::path& path, mapping_t* mapped) {
+    *mapped = { INVALID_HANDLE_VALUE, nullptr, nullptr, 0 };
+    mapped->file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (mapped->file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mapped->file, &size) || size.QuadPart == 0) {
+        CloseHandle(mapped->file);
+        return false;
+    }
+    mapped->mapping = CreateFileMappingW(mapped->file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+    if (mapped->mapping == nullptr) {
+        CloseHandle(mapped->file);
+        return false;
+    }
+    mapped->data = static_cast<uint8_t*>(MapViewOfFile(mapped->mapping, FILE_MAP_WRITE, 0, 0, 0));
+    if (mapped->data == nullptr) {
+        CloseHandle(mapped->mapping);
+        CloseHandle(mapped->file);
+        return false;
+    }
+    mapped->size = static_cast<size_t>(size.QuadPart);
+    return true;
+}
+
+/**
+ * @brief Writes back and releases a mapping.
+ *
+ * @param mapped Mapping to release
+ * @return void
+ */
+void unmapFile(mapping_t* mapped) {
+    FlushViewOfFile(mapped->data, 0);
+    UnmapViewOfFile(mapped->data);
+    CloseHandle(mapped->mapping);
+    CloseHandle(mapped->file);
+}
+
+/**
+ * @brief Reads the table the old Python patcher last wrote.
+ *
+ * @return Parsed table, empty if there is none
+ */
+Scanner::RuntimeSignature readLegacyState() {
+    Scanner::RuntimeSignature table;
+    std::ifstream file(legacyStateFile);
+    if (std::getline(file, legacyTable)) {
+        table.assign(legacyTable.c_str(), Scanner::Section::Data);
+    }
+    return table;
+}
+
+/**
+ * @brief Patches the resolution table of a single game DLL.
+ *
+ * @details
+ * The table is looked for at the offset recorded by the previous run first, it must still hold
+ * exactly what was written back then. Otherwise the DLL is scanned for the original table, and
+ * failing that for the table the old Python patcher wrote. The DLL is only written to if the
+ * table does not already hold the desired resolution.
+ *
+ * @param path Path to the game DLL
+ * @param dll Name of the game DLL
+ * @param table Table to write
+ * @param previous Record of the previous run for this DLL, may be null
+ * @param legacy Table written by the old Python patcher, may be empty
+ * @return result_t
+ */
+result_t patchDll(
+    const std::filesystem::path& path,
+    const std::string& dll,
+    const Resolution::table_t& table,
+    const record_t* previous,
+    const Scanner::Pattern& legacy
+) {
+    result_t result = { false, { dll, 0, table[0].width, table[0].height }, {} };
+    mapping_t mapped;
+    if (!mapFile(path, &mapped)) {
+        result.message = std::format("Cannot open {}, make sure the game is closed", path.string());
+        return result;
+    }
+
+    bool found = false;
+    if (previous != nullptr && previous->offset + sizeof(table) <= mapped.size) {
+        Resolution::table_t written = Resolution::makeTable(previous->width, previous->height);
+        if (memcmp(mapped.data + previous->offset, written.data(), sizeof(written)) == 0) {
+            result.record.offset = previous->offset;
+            found = true;
+        }
+    }
+    std::vector<uint64_t> addr;
+    if (!found) {
+        Scanner::scan(mapped.data, mapped.size, Resolution::originalTable.pattern(), &addr);
+    }
+    if (!found && addr.empty() && legacy.size == sizeof(table)) {
+        Scanner::scan(mapped.data, mapped.size, legacy, &addr);
+    }
+    if (!found && !addr.empty()) {
+        result.record.offset = addr[0] - (uint64_t)mapped.data;
+        found = true;
+    }
+
+    if (!found) {
+        result.message = "Cannot find resolution table, delete and reinstall the game and try again";
+    }
+    else if (memcmp(mapped.data + result.record.offset, table.data(), sizeof(table)) == 0) {
+        result.ok = true;
+        result.message = std::format("Already patched @ 0x{:x}", result.record.offset);
+    }
+    else {
+        memcpy(mapped.data + result.record.offset, table.data(), sizeof(table));
+        result.ok = true;
+        result.message = std::format("Patched @ 0x{:x}", result.record.offset);
+    }
+    unmapFile(&mapped);
+    return result;
+}
+
+/**
+ * @brief Reads the resolution from the YAML file and patches every game DLL with it.
+ *
+ * @param argc Number of arguments
+ * @param argv Arguments, the optional first one is the game folder
+ * @return 0 if every game DLL was patched
+ */
+int main(int argc, char** argv) {
+    std::filesystem::path gameFolder = argc > 1 ? argv[1] : "..";
+
+    int width = 0;
+    int height = 0;
+    int monitor = 0;
+    try {
+        YAML::Node config = YAML::LoadFile(ymlFile);
+        width = config["resolution"]["width"].as<int>();
+        height = config["resolution"]["height"].as<int>();
+        monitor = config["resolution"]["monitor"].as<int>(0);
+    }
+    catch (const YAML::Exception& e) {
+        LOG("Cannot read {}: {}", ymlFile, e.what());
+        return 1;
+    }
+    LOG("YAML: resolution: width:  {}", width);
+    LOG("YAML: resolution: height: {}", height);
+    LOG("YAML: resolution: monitor: {}", monitor);
+    if (width <= 0 || height <= 0) {
+        // The game is not running, a monitor of 0 is always the primary monitor here
+        Display::monitor_t display = Display::resolve(monitor, NULL);
+        width = display.width;
+        height = display.height;
+    }
+    if (width <= 0 || height <= 0) {
+        LOG("Cannot get the monitor resolution, set a width and height in {}", ymlFile);
+        return 1;
+    }
+    LOG("Patching resolution table with {}x{}", width, height);
+
+    auto start = std::chrono::steady_clock::now();
+    Resolution::table_t table = Resolution::makeTable(width, height);
+    std::vector<record_t> previous = readState();
+    Scanner::RuntimeSignature legacy = readLegacyState();
+
+    std::vector<result_t> results(gameDllTable.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < gameDllTable.size(); i++) {
+        const record_t* record = nullptr;
+        for (const record_t& candidate : previous) {
+            if (candidate.dll == gameDllTable[i]) {
+                record = &candidate;
+            }
+        }
+        workers.emplace_back([&, i, record]() {
+            results[i] = patchDll(gameFolder / gameDllTable[i], gameDllTable[i], table, record, legacy.pattern());
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+    // DLL's that failed keep their previous record so they can still be found next time
+    std::vector<record_t> records;
+    int failures = 0;
+    for (size_t i = 0; i < results.size(); i++) {
+        LOG("{}: {}", gameDllTable[i], results[i].message);
+        if (results[i].ok) {
+            records.push_back(results[i].record);
+            continue;
+        }
+        failures++;
+        for (const record_t& candidate : previous) {
+            if (candidate.dll == gameDllTable[i]) {
+                records.push_back(candidate);
+            }
+        }
+    }
+    writeState(records);
+    LOG("Done in {:.1f}ms, {} of {} DLL's patched", elapsed.count(), results.size() - failures, results.size());
+
+    LOG("Press enter to exit...");
+    std::cin.get();
+    return failures == 0 ? 0 : 1;
+}
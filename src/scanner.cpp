@@ -0,0 +1,395 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <bit>
+#include <atomic>
+#include <thread>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "scanner.hpp"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SCANNER_TARGET_AVX2
+#else
+#define SCANNER_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace
+{
+    // Chunks smaller than this are not worth a thread
+    constexpr size_t MIN_CHUNK_SIZE = 256 * 1024;
+    // The game keeps loading while we scan, so never take more than this many cores
+    constexpr size_t MAX_THREADS = 8;
+    // More chunks than threads so a thread that finishes early picks up more work
+    constexpr size_t CHUNKS_PER_THREAD = 4;
+
+    bool cpuHasAvx2() {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    inline bool verify(const uint8_t* data, const Scanner::Pattern& pattern) {
+        const uint8_t* bytes = pattern.bytes;
+        const uint8_t* mask = pattern.mask;
+        for (size_t j = 0; j < pattern.size; ++j) {
+            if ((data[j] & mask[j]) != bytes[j]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void scanScalar(const uint8_t* data, size_t size, const Scanner::Pattern& pattern, size_t start, std::vector<uint64_t>* address) {
+        size_t last = size - pattern.size;
+        for (size_t i = start; i <= last; ++i) {
+            if (verify(data + i, pattern)) {
+                address->push_back((uint64_t)&data[i]);
+            }
+        }
+    }
+
+    void scanSse2(const uint8_t* data, size_t size, const Scanner::Pattern& pattern, std::vector<uint64_t>* address) {
+        const size_t last = size - pattern.size;
+        const size_t reach = std::max(pattern.anchor, pattern.anchor2) + 16;
+        const __m128i a1 = _mm_set1_epi8((char)pattern.bytes[pattern.anchor]);
+        const __m128i a2 = _mm_set1_epi8((char)pattern.bytes[pattern.anchor2]);
+
+        size_t i = 0;
+        for (; i + reach <= size; i += 16) {
+            __m128i c1 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i + pattern.anchor)), a1);
+            __m128i c2 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i + pattern.anchor2)), a2);
+            uint32_t bits = (uint32_t)_mm_movemask_epi8(_mm_and_si128(c1, c2));
+            while (bits) {
+                size_t k = i + std::countr_zero(bits);
+                bits &= bits - 1;
+                if (k <= last && verify(data + k, pattern)) {
+                    address->push_back((uint64_t)&data[k]);
+                }
+            }
+        }
+        scanScalar(data, size, pattern, i, address);
+    }
+
+    SCANNER_TARGET_AVX2
+    void scanAvx2(const uint8_t* data, size_t size, const Scanner::Pattern& pattern, std::vector<uint64_t>* address) {
+        const size_t last = size - pattern.size;
+        const size_t reach = std::max(pattern.anchor, pattern.anchor2) + 32;
+        const __m256i a1 = _mm256_set1_epi8((char)pattern.bytes[pattern.anchor]);
+        const __m256i a2 = _mm256_set1_epi8((char)pattern.bytes[pattern.anchor2]);
+
+        size_t i = 0;
+        for (; i + reach <= size; i += 32) {
+            __m256i c1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i + pattern.anchor)), a1);
+            __m256i c2 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i + pattern.anchor2)), a2);
+            uint32_t bits = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(c1, c2));
+            while (bits) {
+                size_t k = i + std::countr_zero(bits);
+                bits &= bits - 1;
+                if (k <= last && verify(data + k, pattern)) {
+                    address->push_back((uint64_t)&data[k]);
+                }
+            }
+        }
+        _mm256_zeroupper();
+        scanScalar(data, size, pattern, i, address);
+    }
+
+    /**
+     * @brief Patterns sharing the same primary anchor byte.
+     *
+     */
+    typedef struct bucket_t {
+        uint8_t anchor;
+        std::vector<size_t> patterns;
+    } bucket_t;
+
+    /**
+     * @brief Verify every pattern of a bucket against a position where their anchor byte was seen.
+     *
+     */
+    inline void verifyBucket(
+        const uint8_t* data,
+        size_t size,
+        size_t position,
+        const bucket_t& bucket,
+        const std::vector<const Scanner::Pattern*>& patterns,
+        std::vector<std::vector<uint64_t>>* addresses
+    ) {
+        for (size_t index : bucket.patterns) {
+            const Scanner::Pattern& pattern = *patterns[index];
+            if (position < pattern.anchor) {
+                continue;
+            }
+            size_t start = position - pattern.anchor;
+            if (start + pattern.size <= size && verify(data + start, pattern)) {
+                (*addresses)[index].push_back((uint64_t)&data[start]);
+            }
+        }
+    }
+
+    void scanBatchScalar(
+        const uint8_t* data,
+        size_t size,
+        size_t start,
+        const std::vector<bucket_t>& buckets,
+        const std::array<int16_t, 256>& bucketOf,
+        const std::vector<const Scanner::Pattern*>& patterns,
+        std::vector<std::vector<uint64_t>>* addresses
+    ) {
+        for (size_t i = start; i < size; ++i) {
+            int16_t bucket = bucketOf[data[i]];
+            if (bucket >= 0) {
+                verifyBucket(data, size, i, buckets[bucket], patterns, addresses);
+            }
+        }
+    }
+
+    void scanBatchSse2(
+        const uint8_t* data,
+        size_t size,
+        const std::vector<bucket_t>& buckets,
+        const std::array<int16_t, 256>& bucketOf,
+        const std::vector<const Scanner::Pattern*>& patterns,
+        std::vector<std::vector<uint64_t>>* addresses
+    ) {
+        // At most one bucket per byte value
+        __m128i anchors[256];
+        for (size_t b = 0; b < buckets.size(); ++b) {
+            anchors[b] = _mm_set1_epi8((char)buckets[b].anchor);
+        }
+
+        size_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+            for (size_t b = 0; b < buckets.size(); ++b) {
+                uint32_t bits = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, anchors[b]));
+                while (bits) {
+                    size_t k = i + std::countr_zero(bits);
+                    bits &= bits - 1;
+                    verifyBucket(data, size, k, buckets[b], patterns, addresses);
+                }
+            }
+        }
+        scanBatchScalar(data, size, i, buckets, bucketOf, patterns, addresses);
+    }
+
+    SCANNER_TARGET_AVX2
+    void scanBatchAvx2(
+        const uint8_t* data,
+        size_t size,
+        const std::vector<bucket_t>& buckets,
+        const std::array<int16_t, 256>& bucketOf,
+        const std::vector<const Scanner::Pattern*>& patterns,
+        std::vector<std::vector<uint64_t>>* addresses
+    ) {
+        // At most one bucket per byte value
+        __m256i anchors[256];
+        for (size_t b = 0; b < buckets.size(); ++b) {
+            anchors[b] = _mm256_set1_epi8((char)buckets[b].anchor);
+        }
+
+        size_t i = 0;
+        for (; i + 32 <= size; i += 32) {
+            __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+            for (size_t b = 0; b < buckets.size(); ++b) {
+                uint32_t bits = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, anchors[b]));
+                while (bits) {
+                    size_t k = i + std::countr_zero(bits);
+                    bits &= bits - 1;
+                    verifyBucket(data, size, k, buckets[b], patterns, addresses);
+                }
+            }
+        }
+        _mm256_zeroupper();
+        scanBatchScalar(data, size, i, buckets, bucketOf, patterns, addresses);
+    }
+}
+
+namespace Scanner
+{
+    RuntimeSignature parse(const char* signature, Section section) {
+        RuntimeSignature parsed;
+        parsed.assign(signature, section);
+        return parsed;
+    }
+
+    bool match(const uint8_t* data, const Pattern& pattern) {
+        return pattern.size > 0 && verify(data, pattern);
+    }
+
+    Engine bestEngine() {
+        static const Engine engine = cpuHasAvx2() ? Engine::Avx2 : Engine::Sse2;
+        return engine;
+    }
+
+    void scan(const uint8_t* data, size_t size, const Pattern& pattern, std::vector<uint64_t>* address, Engine engine) {
+        if (pattern.size == 0 || size < pattern.size) {
+            return;
+        }
+        if (engine == Engine::Auto) {
+            engine = bestEngine();
+        }
+        if (pattern.wildcardOnly) {
+            engine = Engine::Scalar;
+        }
+
+        switch (engine) {
+        case Engine::Avx2:
+            scanAvx2(data, size, pattern, address);
+            break;
+        case Engine::Sse2:
+            scanSse2(data, size, pattern, address);
+            break;
+        default:
+            scanScalar(data, size, pattern, 0, address);
+            break;
+        }
+    }
+
+    void scanBatch(const uint8_t* data, size_t size, const std::vector<const Pattern*>& patterns, std::vector<std::vector<uint64_t>>* addresses, Engine engine) {
+        addresses->assign(patterns.size(), {});
+        if (engine == Engine::Auto) {
+            engine = bestEngine();
+        }
+
+        // Group the patterns by anchor byte, wildcard only patterns cannot be bucketed
+        std::vector<bucket_t> buckets;
+        std::array<int16_t, 256> bucketOf;
+        bucketOf.fill(-1);
+        for (size_t i = 0; i < patterns.size(); ++i) {
+            const Pattern& pattern = *patterns[i];
+            if (pattern.size == 0 || size < pattern.size) {
+                continue;
+            }
+            if (pattern.wildcardOnly) {
+                scan(data, size, pattern, &(*addresses)[i], Engine::Scalar);
+                continue;
+            }
+            uint8_t anchor = pattern.bytes[pattern.anchor];
+            if (bucketOf[anchor] < 0) {
+                bucketOf[anchor] = (int16_t)buckets.size();
+                buckets.push_back({ anchor, {} });
+            }
+            buckets[bucketOf[anchor]].patterns.push_back(i);
+        }
+        if (buckets.empty()) {
+            return;
+        }
+
+        switch (engine) {
+        case Engine::Avx2:
+            scanBatchAvx2(data, size, buckets, bucketOf, patterns, addresses);
+            break;
+        case Engine::Sse2:
+            scanBatchSse2(data, size, buckets, bucketOf, patterns, addresses);
+            break;
+        default:
+            scanBatchScalar(data, size, 0, buckets, bucketOf, patterns, addresses);
+            break;
+        }
+    }
+
+    void scanBatchParallel(const uint8_t* data, size_t size, const std::vector<const Pattern*>& patterns, std::vector<std::vector<uint64_t>>* addresses, size_t threads, Engine engine) {
+        if (threads == 0) {
+            size_t cores = std::thread::hardware_concurrency();
+            threads = cores > 1 ? cores - 1 : 1;
+        }
+        threads = std::min(threads, MAX_THREADS);
+        size_t chunks = std::min(threads * CHUNKS_PER_THREAD, size / MIN_CHUNK_SIZE);
+        if (threads <= 1 || chunks <= 1) {
+            scanBatch(data, size, patterns, addresses, engine);
+            return;
+        }
+        if (engine == Engine::Auto) {
+            engine = bestEngine();
+        }
+
+        size_t longest = 0;
+        for (const Pattern* pattern : patterns) {
+            longest = std::max(longest, pattern->size);
+        }
+        size_t chunkSize = (size + chunks - 1) / chunks;
+
+        std::vector<std::vector<std::vector<uint64_t>>> results(chunks);
+        std::atomic<size_t> next = 0;
+        auto worker = [&]() {
+            for (size_t chunk = next++; chunk < chunks; chunk = next++) {
+                size_t begin = chunk * chunkSize;
+                size_t end = std::min(begin + chunkSize, size);
+                size_t reach = longest > 0 ? std::min(end + longest - 1, size) : end;
+                scanBatch(data + begin, reach - begin, patterns, &results[chunk], engine);
+                // Hits starting in the overlap belong to the next chunk
+                for (std::vector<uint64_t>& hits : results[chunk]) {
+                    hits.erase(std::lower_bound(hits.begin(), hits.end(), (uint64_t)(data + end)), hits.end());
+                }
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (size_t i = 1; i < threads && i < chunks; ++i) {
+            try {
+                pool.emplace_back(worker);
+            }
+            catch (...) {
+                // The calling thread picks up whatever is left
+                break;
+            }
+        }
+        worker();
+        for (std::thread& thread : pool) {
+            thread.join();
+        }
+
+        addresses->assign(patterns.size(), {});
+        for (const auto& chunk : results) {
+            for (size_t i = 0; i < patterns.size(); ++i) {
+                (*addresses)[i].insert((*addresses)[i].end(), chunk[i].begin(), chunk[i].end());
+            }
+        }
+    }
+}
@@ -0,0 +1,238 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <windows.h>
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "Zydis/Zydis.h"
+#include "safetyhook.hpp"
+
+#include "stub.hpp"
+
+namespace Stub
+{
+    void Assembler::emit(ZydisMnemonic mnemonic, std::initializer_list<ZydisEncoderOperand> operands) {
+        ZydisEncoderRequest request;
+        memset(&request, 0, sizeof(request));
+        request.machine_mode = ZYDIS_MACHINE_MODE_LONG_64;
+        request.mnemonic = mnemonic;
+        for (const auto& operand : operands) {
+            request.operands[request.operand_count++] = operand;
+        }
+
+        ZyanU8 buffer[ZYDIS_MAX_INSTRUCTION_LENGTH];
+        ZyanUSize length = sizeof(buffer);
+        if (ZYAN_SUCCESS(ZydisEncoderEncodeInstruction(&request, buffer, &length))) {
+            m_code.insert(m_code.end(), buffer, buffer + length);
+        }
+        else {
+            m_ok = false;
+        }
+    }
+
+    size_t Assembler::jump(ZydisMnemonic mnemonic) {
+        ZydisEncoderRequest request;
+        memset(&request, 0, sizeof(request));
+        request.machine_mode = ZYDIS_MACHINE_MODE_LONG_64;
+        request.mnemonic = mnemonic;
+        request.branch_type = ZYDIS_BRANCH_TYPE_NEAR;
+        request.branch_width = ZYDIS_BRANCH_WIDTH_32;
+        request.operand_count = 1;
+        request.operands[0] = imm(0);
+
+        ZyanU8 buffer[ZYDIS_MAX_INSTRUCTION_LENGTH];
+        ZyanUSize length = sizeof(buffer);
+        if (ZYAN_SUCCESS(ZydisEncoderEncodeInstruction(&request, buffer, &length)) && length >= 5) {
+            m_code.insert(m_code.end(), buffer, buffer + length);
+        }
+        else {
+            m_ok = false;
+        }
+        // The 32 bit displacement is always the last part of the instruction
+        return m_code.size() - sizeof(int32_t);
+    }
+
+    void Assembler::bind(size_t fixup) {
+        if (!m_ok) {
+            return;
+        }
+        int32_t displacement = (int32_t)(m_code.size() - (fixup + sizeof(int32_t)));
+        memcpy(m_code.data() + fixup, &displacement, sizeof(displacement));
+    }
+
+    size_t Assembler::jumpAbsolute(uintptr_t target) {
+        const uint8_t jmp[] = { 0xFF, 0x25, 0x00, 0x00, 0x00, 0x00 };
+        m_code.insert(m_code.end(), jmp, jmp + sizeof(jmp));
+        size_t slot = m_code.size();
+        m_code.resize(m_code.size() + sizeof(target));
+        memcpy(m_code.data() + slot, &target, sizeof(target));
+        return slot;
+    }
+
+    ZydisEncoderOperand reg(ZydisRegister value) {
+        ZydisEncoderOperand operand;
+        memset(&operand, 0, sizeof(operand));
+        operand.type = ZYDIS_OPERAND_TYPE_REGISTER;
+        operand.reg.value = value;
+        return operand;
+    }
+
+    ZydisEncoderOperand imm(int64_t value) {
+        ZydisEncoderOperand operand;
+        memset(&operand, 0, sizeof(operand));
+        operand.type = ZYDIS_OPERAND_TYPE_IMMEDIATE;
+        operand.imm.s = value;
+        return operand;
+    }
+
+    ZydisEncoderOperand mem(ZydisRegister base, int64_t displacement, uint16_t size) {
+        ZydisEncoderOperand operand;
+        memset(&operand, 0, sizeof(operand));
+        operand.type = ZYDIS_OPERAND_TYPE_MEMORY;
+        operand.mem.base = base;
+        operand.mem.index = ZYDIS_REGISTER_NONE;
+        operand.mem.displacement = displacement;
+        operand.mem.size = size;
+        return operand;
+    }
+
+    bool create(
+        const std::shared_ptr<safetyhook::Allocator>& allocator,
+        void* target,
+        emitter_t emitter,
+        SafetyHookInline* hook,
+        safetyhook::Allocation* code
+    ) {
+        Assembler a;
+        emitter(a);
+        size_t trampolineSlot = a.jumpAbsolute(0);
+        if (!a.ok()) {
+            return false;
+        }
+
+        auto allocation = allocator->allocate_near({ (uint8_t*)target }, a.code().size());
+        if (!allocation) {
+            return false;
+        }
+        memcpy(allocation->data(), a.code().data(), a.code().size());
+
+        auto inlineHook = safetyhook::InlineHook::create(allocator, target, allocation->data(), safetyhook::InlineHook::StartDisabled);
+        if (!inlineHook) {
+            return false;
+        }
+        uintptr_t trampoline = inlineHook->trampoline().address();
+        memcpy(allocation->data() + trampolineSlot, &trampoline, sizeof(trampoline));
+        FlushInstructionCache(GetCurrentProcess(), allocation->data(), a.code().size());
+        if (!inlineHook->enable()) {
+            return false;
+        }
+
+        *hook = std::move(*inlineHook);
+        *code = std::move(*allocation);
+        return true;
+    }
+
+    bool createGuarded(
+        const std::shared_ptr<safetyhook::Allocator>& allocator,
+        void* target,
+        std::span<const guard_t> guards,
+        safetyhook::MidHookFn callback,
+        SafetyHookInline* hook,
+        SafetyMidHook* midHook,
+        safetyhook::Allocation* code
+    ) {
+        // Room for the mid hook to place its jump in, even the 14 byte absolute one
+        constexpr size_t LANDING_SIZE = 16;
+
+        Assembler a;
+        std::vector<size_t> rejects;
+        a.emit(ZYDIS_MNEMONIC_PUSHFQ, {});
+        for (const guard_t& guard : guards) {
+            if (guard.test == Test::RegisterEquals) {
+                a.emit(ZYDIS_MNEMONIC_CMP, { reg(guard.reg), imm(guard.value) });
+                rejects.push_back(a.jump(ZYDIS_MNEMONIC_JNZ));
+            }
+            else if (guard.test == Test::Memory32Equals) {
+                a.emit(ZYDIS_MNEMONIC_CMP, { mem(guard.reg, guard.displacement, 4), imm(guard.value) });
+                rejects.push_back(a.jump(ZYDIS_MNEMONIC_JNZ));
+            }
+            else {
+                // pop leaves the flags of the cmp alone
+                a.emit(ZYDIS_MNEMONIC_PUSH, { reg(ZYDIS_REGISTER_RAX) });
+                a.emit(ZYDIS_MNEMONIC_MOV, { reg(ZYDIS_REGISTER_RAX), imm((int64_t)guard.address) });
+                a.emit(ZYDIS_MNEMONIC_CMP, { mem(ZYDIS_REGISTER_RAX, 0, 1), imm(0) });
+                a.emit(ZYDIS_MNEMONIC_POP, { reg(ZYDIS_REGISTER_RAX) });
+                rejects.push_back(a.jump(ZYDIS_MNEMONIC_JZ));
+            }
+        }
+        a.emit(ZYDIS_MNEMONIC_POPFQ, {});
+        // The mid hook goes on these nops, it returns to the jump right after them
+        size_t landing = a.code().size();
+        for (size_t i = 0; i < LANDING_SIZE; ++i) {
+            a.emit(ZYDIS_MNEMONIC_NOP, {});
+        }
+        size_t acceptSlot = a.jumpAbsolute(0);
+        for (size_t reject : rejects) {
+            a.bind(reject);
+        }
+        a.emit(ZYDIS_MNEMONIC_POPFQ, {});
+        size_t rejectSlot = a.jumpAbsolute(0);
+        if (!a.ok()) {
+            return false;
+        }
+
+        auto allocation = allocator->allocate_near({ (uint8_t*)target }, a.code().size());
+        if (!allocation) {
+            return false;
+        }
+        memcpy(allocation->data(), a.code().data(), a.code().size());
+
+        auto inlineHook = safetyhook::InlineHook::create(allocator, target, allocation->data(), safetyhook::InlineHook::StartDisabled);
+        if (!inlineHook) {
+            return false;
+        }
+        uintptr_t trampoline = inlineHook->trampoline().address();
+        memcpy(allocation->data() + acceptSlot, &trampoline, sizeof(trampoline));
+        memcpy(allocation->data() + rejectSlot, &trampoline, sizeof(trampoline));
+
+        auto landingHook = safetyhook::MidHook::create(allocator, allocation->data() + landing, callback);
+        if (!landingHook) {
+            return false;
+        }
+        FlushInstructionCache(GetCurrentProcess(), allocation->data(), a.code().size());
+        if (!inlineHook->enable()) {
+            return false;
+        }
+
+        *hook = std::move(*inlineHook);
+        *midHook = std::move(*landingHook);
+        *code = std::move(*allocation);
+        return true;
+    }
+}
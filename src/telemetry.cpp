@@ -0,0 +1,312 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <windows.h>
+#include <d3d11.h>
+#include <dxgi.h>
+#include <atomic>
+#include <array>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <format>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+
+#include "spdlog/spdlog.h"
+#include "safetyhook.hpp"
+
+#include "telemetry.hpp"
+#include "callbacks.hpp"
+#ifdef HOOK_METRICS
+#include "metrics.hpp"
+#endif
+
+namespace
+{
+    // Index of IDXGISwapChain::Present in the swap chain vtable
+    constexpr size_t PRESENT_INDEX = 8;
+
+    // Bit n of `frame_t::fixes` is the n-th switch
+    const std::array<const std::atomic<uint8_t>*, 7> switches = {
+        &Callbacks::toggles.centerUi,
+        &Callbacks::toggles.viewport,
+        &Callbacks::toggles.textBubblePlacement,
+        &Callbacks::toggles.combatOverlay,
+        &Callbacks::toggles.uiElements,
+        &Callbacks::toggles.cutscene,
+        &Callbacks::toggles.constrainAntiAliasing,
+    };
+
+    SafetyHookInline presentHook;
+    std::vector<std::string> moduleNames;
+
+    // Single producer, the game's render thread, and single consumer, the writer thread
+    std::array<Telemetry::frame_t, Telemetry::RING_SIZE> ring;
+    alignas(64) std::atomic<uint64_t> head{ 0 };
+    alignas(64) std::atomic<uint64_t> tail{ 0 };
+    alignas(64) std::atomic<uint64_t> dropped{ 0 };
+    std::atomic<uint32_t> currentModule{ Telemetry::NO_MODULE };
+    // Width in the high half, height in the low half
+    std::atomic<uint32_t> currentResolution{ 0 };
+    std::atomic<HWND> gameWindow{ nullptr };
+
+    uint32_t activeFixes() {
+        uint32_t fixes = 0;
+        for (size_t i = 0; i < switches.size(); ++i) {
+            fixes |= Callbacks::enabled(*switches[i]) ? (1u << i) : 0;
+        }
+        return fixes;
+    }
+
+    HRESULT __stdcall present(IDXGISwapChain* swapChain, UINT syncInterval, UINT flags) {
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        uint64_t slot = head.load(std::memory_order_relaxed);
+        if (slot - tail.load(std::memory_order_acquire) < Telemetry::RING_SIZE) {
+            Telemetry::frame_t& frame = ring[slot % Telemetry::RING_SIZE];
+            uint32_t resolution = currentResolution.load(std::memory_order_relaxed);
+            frame.qpc = now.QuadPart;
+#ifdef HOOK_METRICS
+            frame.hookCycles = Metrics::totalCycles();
+#else
+            frame.hookCycles = 0;
+#endif
+            frame.fixes = activeFixes();
+            frame.width = (uint16_t)(resolution >> 16);
+            frame.height = (uint16_t)(resolution & 0xFFFF);
+            frame.module = currentModule.load(std::memory_order_relaxed);
+            head.store(slot + 1, std::memory_order_release);
+        }
+        else {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (gameWindow.load(std::memory_order_relaxed) == nullptr) {
+            DXGI_SWAP_CHAIN_DESC desc;
+            if (SUCCEEDED(swapChain->GetDesc(&desc))) {
+                gameWindow.store(desc.OutputWindow, std::memory_order_relaxed);
+            }
+        }
+        return presentHook.stdcall<HRESULT>(swapChain, syncInterval, flags);
+    }
+
+    void* findPresent() {
+        WNDCLASSEXW windowClass = {};
+        windowClass.cbSize = sizeof(windowClass);
+        windowClass.lpfnWndProc = DefWindowProcW;
+        windowClass.hInstance = GetModuleHandleW(NULL);
+        windowClass.lpszClassName = L"HackGULastRecodeFixPresent";
+        RegisterClassExW(&windowClass);
+        HWND window = CreateWindowExW(0, windowClass.lpszClassName, L"", WS_OVERLAPPEDWINDOW,
+            0, 0, 8, 8, NULL, NULL, windowClass.hInstance, NULL);
+
+        DXGI_SWAP_CHAIN_DESC desc = {};
+        desc.BufferCount = 1;
+        desc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+        desc.OutputWindow = window;
+        desc.SampleDesc.Count = 1;
+        desc.Windowed = TRUE;
+        desc.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
+
+        void* target = nullptr;
+        for (D3D_DRIVER_TYPE driver : { D3D_DRIVER_TYPE_HARDWARE, D3D_DRIVER_TYPE_WARP }) {
+            IDXGISwapChain* swapChain = nullptr;
+            ID3D11Device* device = nullptr;
+            ID3D11DeviceContext* context = nullptr;
+            HRESULT result = D3D11CreateDeviceAndSwapChain(NULL, driver, NULL, 0, NULL, 0, D3D11_SDK_VERSION,
+                &desc, &swapChain, &device, NULL, &context);
+            if (SUCCEEDED(result)) {
+                target = (*reinterpret_cast<void***>(swapChain))[PRESENT_INDEX];
+                context->Release();
+                device->Release();
+                swapChain->Release();
+                break;
+            }
+        }
+        DestroyWindow(window);
+        UnregisterClassW(windowClass.lpszClassName, windowClass.hInstance);
+        return target;
+    }
+
+#if HOOK_TELEMETRY_OVERLAY
+    char overlayText[128] = "";
+
+    LRESULT CALLBACK overlayProc(HWND window, UINT message, WPARAM wParam, LPARAM lParam) {
+        if (message == WM_PAINT) {
+            PAINTSTRUCT paint;
+            HDC dc = BeginPaint(window, &paint);
+            RECT rect;
+            GetClientRect(window, &rect);
+            // Black is the color key, everything but the text is see through
+            FillRect(dc, &rect, (HBRUSH)GetStockObject(BLACK_BRUSH));
+            SetBkMode(dc, TRANSPARENT);
+            SetTextColor(dc, RGB(255, 255, 0));
+            DrawTextA(dc, overlayText, -1, &rect, DT_LEFT | DT_TOP | DT_SINGLELINE);
+            EndPaint(window, &paint);
+            return 0;
+        }
+        return DefWindowProcW(window, message, wParam, lParam);
+    }
+
+    HWND createOverlay() {
+        WNDCLASSEXW windowClass = {};
+        windowClass.cbSize = sizeof(windowClass);
+        windowClass.lpfnWndProc = overlayProc;
+        windowClass.hInstance = GetModuleHandleW(NULL);
+        windowClass.lpszClassName = L"HackGULastRecodeFixOverlay";
+        RegisterClassExW(&windowClass);
+        HWND window = CreateWindowExW(
+            WS_EX_LAYERED | WS_EX_TRANSPARENT | WS_EX_TOPMOST | WS_EX_TOOLWINDOW | WS_EX_NOACTIVATE,
+            windowClass.lpszClassName, L"", WS_POPUP, 0, 0, 480, 20, NULL, NULL, windowClass.hInstance, NULL);
+        if (window != NULL) {
+            SetLayeredWindowAttributes(window, RGB(0, 0, 0), 0, LWA_COLORKEY);
+        }
+        return window;
+    }
+
+    void updateOverlay(HWND overlay) {
+        HWND game = gameWindow.load(std::memory_order_relaxed);
+        if (overlay == NULL || game == NULL) {
+            return;
+        }
+        POINT origin = { 8, 8 };
+        ClientToScreen(game, &origin);
+        SetWindowPos(overlay, HWND_TOPMOST, origin.x, origin.y, 0, 0, SWP_NOSIZE | SWP_NOACTIVATE | SWP_SHOWWINDOW);
+        InvalidateRect(overlay, NULL, TRUE);
+        MSG message;
+        while (PeekMessageW(&message, overlay, 0, 0, PM_REMOVE)) {
+            DispatchMessageW(&message);
+        }
+    }
+#endif
+
+    void writer(std::string path, uint32_t intervalMs) {
+        std::ofstream csv(path, std::ios::trunc);
+        csv << "frame,time_ms,frame_ms,hook_cycles,fixes,module,width,height\n";
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        double msPerTick = 1000.0 / (double)frequency.QuadPart;
+#if HOOK_TELEMETRY_OVERLAY
+        HWND overlay = createOverlay();
+#endif
+        uint64_t index = 0;
+        int64_t firstQpc = 0;
+        int64_t lastQpc = 0;
+        uint64_t lastCycles = 0;
+        uint64_t reportedDropped = 0;
+        while (1) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+            uint64_t end = head.load(std::memory_order_acquire);
+            uint64_t begin = tail.load(std::memory_order_relaxed);
+            size_t frames = 0;
+            double totalMs = 0;
+            double maxMs = 0;
+            uint64_t totalCycles = 0;
+            for (uint64_t slot = begin; slot < end; ++slot) {
+                const Telemetry::frame_t& frame = ring[slot % Telemetry::RING_SIZE];
+                if (index == 0) {
+                    firstQpc = frame.qpc;
+                    lastQpc = frame.qpc;
+                    lastCycles = frame.hookCycles;
+                }
+                double frameMs = (double)(frame.qpc - lastQpc) * msPerTick;
+                uint64_t cycles = frame.hookCycles - lastCycles;
+                const char* module = frame.module < moduleNames.size() ? moduleNames[frame.module].c_str() : "none";
+                csv << std::format("{},{:.3f},{:.3f},{},{:02x},{},{},{}\n",
+                    index,
+                    (double)(frame.qpc - firstQpc) * msPerTick,
+                    frameMs,
+                    cycles,
+                    frame.fixes,
+                    module,
+                    frame.width,
+                    frame.height
+                );
+                lastQpc = frame.qpc;
+                lastCycles = frame.hookCycles;
+                index++;
+                frames++;
+                totalMs += frameMs;
+                maxMs = (std::max)(maxMs, frameMs);
+                totalCycles += cycles;
+            }
+            tail.store(end, std::memory_order_release);
+            csv.flush();
+
+            uint64_t droppedNow = dropped.load(std::memory_order_relaxed);
+            if (droppedNow != reportedDropped) {
+                spdlog::warn("Telemetry : Ring full, dropped {} frames", droppedNow - reportedDropped);
+                reportedDropped = droppedNow;
+            }
+#if HOOK_TELEMETRY_OVERLAY
+            if (frames > 0) {
+                double averageMs = totalMs / (double)frames;
+                size_t size = std::format_to_n(overlayText, sizeof(overlayText) - 1,
+                    "{:.1f} fps  {:.2f} ms  max {:.2f} ms  hooks {} cycles/frame",
+                    averageMs > 0 ? 1000.0 / averageMs : 0.0, averageMs, maxMs, totalCycles / frames).out - overlayText;
+                overlayText[size] = '\0';
+            }
+            updateOverlay(overlay);
+#endif
+        }
+    }
+}
+
+namespace Telemetry
+{
+    bool start(const std::string& path, const std::vector<std::string>& modules, uint32_t intervalMs) {
+        moduleNames = modules;
+        void* target = findPresent();
+        if (target == nullptr) {
+            spdlog::info("Telemetry : Could not create a swap chain to find the present call");
+            return false;
+        }
+        // Enabled only once it is in `presentHook`, which `present` calls through
+        auto hook = safetyhook::InlineHook::create(target, reinterpret_cast<void*>(present), safetyhook::InlineHook::StartDisabled);
+        if (!hook) {
+            spdlog::info("Telemetry : Could not hook the present call");
+            return false;
+        }
+        presentHook = std::move(*hook);
+        if (!presentHook.enable()) {
+            spdlog::info("Telemetry : Could not enable the present hook");
+            return false;
+        }
+        std::thread(writer, path, intervalMs).detach();
+        spdlog::info("Telemetry : Writing frames to {}", path);
+        return true;
+    }
+
+    void setModule(uint32_t module) {
+        currentModule.store(module, std::memory_order_relaxed);
+    }
+
+    void setResolution(int width, int height) {
+        currentResolution.store(((uint32_t)width << 16) | ((uint32_t)height & 0xFFFF), std::memory_order_relaxed);
+    }
+}
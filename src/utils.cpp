@@ -27,8 +27,11 @@
 #include <format>
 #include <iostream>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 
 #include "utils.hpp"
+#include "scanner.hpp"
 
 namespace Utils
 {
@@ -52,87 +55,157 @@ namespace Utils
         return compiler;
     }
 
-    std::string bytesToString(void* bytes, size_t size) {
-        std::string pattern;
-        for (size_t i = 0; i < size; i++) {
-            pattern += std::format("{:02X} ", ((uint8_t*)bytes)[i]);
-        }
-        if (!pattern.empty()) {
-            pattern.pop_back();
+    hexString_t bytesToString(const void* bytes, size_t size) {
+        static constexpr char digits[] = "0123456789ABCDEF";
+        hexString_t string;
+        string.size = 0;
+        size_t count = size < MAX_HEX_BYTES ? size : MAX_HEX_BYTES;
+        for (size_t i = 0; i < count; i++) {
+            uint8_t byte = static_cast<const uint8_t*>(bytes)[i];
+            if (i > 0) {
+                string.text[string.size++] = ' ';
+            }
+            string.text[string.size++] = digits[byte >> 4];
+            string.text[string.size++] = digits[byte & 0xF];
         }
-        return pattern;
+        return string;
     }
 
-    std::pair<int, int> GetDesktopDimensions() {
-        DEVMODE devMode{};
-        devMode.dmSize = sizeof(DEVMODE);
-        if (EnumDisplaySettings(nullptr, ENUM_CURRENT_SETTINGS, &devMode)) {
-            return { devMode.dmPelsWidth, devMode.dmPelsHeight };
-        }
-        return {};
+    void patch(uintptr_t address, const void* bytes, size_t size)
+    {
+        DWORD oldProtect;
+        VirtualProtect((LPVOID)address, size, PAGE_EXECUTE_READWRITE, &oldProtect);
+        memcpy((LPVOID)address, bytes, size);
+        VirtualProtect((LPVOID)address, size, oldProtect, &oldProtect);
+        FlushInstructionCache(GetCurrentProcess(), (LPCVOID)address, size);
     }
 
     void patch(uintptr_t address, const char* pattern)
     {
-        static auto pattern_to_byte = [](const char* pattern) {
-            auto bytes = std::vector<uint8_t>{};
-            auto start = const_cast<char*>(pattern);
-            auto end = const_cast<char*>(pattern) + strlen(pattern);
-            for (auto current = start; current < end; ++current) {
-                bytes.push_back((uint8_t)strtoul(current, &current, 16));
+        // Parsed and written a chunk at a time so any length fits on the stack
+        uint8_t chunk[64];
+        size_t size = 0;
+        char* current = const_cast<char*>(pattern);
+        char* end = current + strlen(pattern);
+        while (current < end) {
+            char* next = current;
+            uint8_t byte = (uint8_t)strtoul(current, &next, 16);
+            if (next == current) {
+                break;
             }
-            return bytes;
-        };
-
-        DWORD oldProtect;
-        auto patternBytes = pattern_to_byte(pattern);
-        VirtualProtect((LPVOID)address, patternBytes.size(), PAGE_EXECUTE_READWRITE, &oldProtect);
-        memcpy((LPVOID)address, patternBytes.data(), patternBytes.size());
-        VirtualProtect((LPVOID)address, patternBytes.size(), oldProtect, &oldProtect);
+            current = next;
+            chunk[size++] = byte;
+            if (size == sizeof(chunk)) {
+                patch(address, chunk, size);
+                address += size;
+                size = 0;
+            }
+        }
+        if (size > 0) {
+            patch(address, chunk, size);
+        }
     }
 
-    void patternScan(void* module, const char* signature, std::vector<uint64_t>* address)
+    std::vector<region_t> getModuleRegions(void* module)
     {
-        static auto pattern_to_byte = [](const char* pattern) {
-            auto bytes = std::vector<int>{};
-            auto start = const_cast<char*>(pattern);
-            auto end = const_cast<char*>(pattern) + strlen(pattern);
+        auto base = reinterpret_cast<std::uint8_t*>(module);
+        auto dosHeader = (PIMAGE_DOS_HEADER)module;
+        auto ntHeaders = (PIMAGE_NT_HEADERS)(base + dosHeader->e_lfanew);
+        auto sizeOfImage = ntHeaders->OptionalHeader.SizeOfImage;
 
-            for (auto current = start; current < end; ++current) {
-                if (*current == ' ') {
-                    continue;
-                }
-                else if (*current == '?') {
-                    current += 2;
-                    bytes.push_back(-1);
+        std::vector<region_t> regions;
+        auto addRegion = [&regions](std::uint8_t* begin, size_t size, Scanner::Section section) {
+            std::uint8_t* end = begin + size;
+            MEMORY_BASIC_INFORMATION mbi;
+            for (std::uint8_t* current = begin; current < end; ) {
+                if (VirtualQuery(current, &mbi, sizeof(mbi)) == 0) {
+                    break;
                 }
-                else {
-                    bytes.push_back(strtoul(current, &current, 16));
+                std::uint8_t* pageEnd = (std::uint8_t*)mbi.BaseAddress + mbi.RegionSize;
+                std::uint8_t* regionEnd = pageEnd < end ? pageEnd : end;
+                bool readable = mbi.State == MEM_COMMIT && (mbi.Protect & (PAGE_NOACCESS | PAGE_GUARD)) == 0;
+                if (readable) {
+                    region_t* last = regions.empty() ? nullptr : &regions.back();
+                    if (last && last->section == section && last->data + last->size == current) {
+                        last->size += regionEnd - current;
+                    }
+                    else {
+                        regions.push_back({ current, (size_t)(regionEnd - current), section });
+                    }
                 }
+                current = regionEnd;
             }
-            return bytes;
         };
 
-        auto dosHeader = (PIMAGE_DOS_HEADER)module;
-        auto ntHeaders = (PIMAGE_NT_HEADERS)((std::uint8_t*)module + dosHeader->e_lfanew);
+        addRegion(base, ntHeaders->OptionalHeader.SizeOfHeaders, Scanner::Section::Any);
+        auto section = IMAGE_FIRST_SECTION(ntHeaders);
+        for (WORD i = 0; i < ntHeaders->FileHeader.NumberOfSections; ++i, ++section) {
+            if (section->VirtualAddress >= sizeOfImage) {
+                continue;
+            }
+            size_t size = section->Misc.VirtualSize ? section->Misc.VirtualSize : section->SizeOfRawData;
+            if (size > sizeOfImage - section->VirtualAddress) {
+                size = sizeOfImage - section->VirtualAddress;
+            }
 
-        auto sizeOfImage = ntHeaders->OptionalHeader.SizeOfImage;
-        auto patternBytes = pattern_to_byte(signature);
-        auto scanBytes = reinterpret_cast<std::uint8_t*>(module);
+            char name[IMAGE_SIZEOF_SHORT_NAME + 1] = { 0 };
+            memcpy(name, section->Name, IMAGE_SIZEOF_SHORT_NAME);
+            auto characteristics = section->Characteristics;
+            Scanner::Section kind = Scanner::Section::Any;
+            if (characteristics & IMAGE_SCN_MEM_EXECUTE) {
+                kind = Scanner::Section::Code;
+            }
+            else if ((characteristics & IMAGE_SCN_CNT_INITIALIZED_DATA) &&
+                    !(characteristics & IMAGE_SCN_MEM_DISCARDABLE) &&
+                    strcmp(name, ".pdata") != 0 &&
+                    strcmp(name, ".rsrc") != 0) {
+                kind = Scanner::Section::Data;
+            }
+            addRegion(base + section->VirtualAddress, size, kind);
+        }
+        return regions;
+    }
 
-        auto s = patternBytes.size();
-        auto d = patternBytes.data();
+    bool patternMatch(void* module, uint32_t rva, const Scanner::Pattern& pattern)
+    {
+        auto address = reinterpret_cast<std::uint8_t*>(module) + rva;
+        for (const auto& region : getModuleRegions(module)) {
+            if (address >= region.data && address + pattern.size <= region.data + region.size) {
+                return Scanner::match(address, pattern);
+            }
+        }
+        return false;
+    }
 
-        for (auto i = 0ul; i < sizeOfImage - s; ++i) {
-            bool found = true;
-            for (auto j = 0ul; j < s; ++j) {
-                if (scanBytes[i + j] != d[j] && d[j] != -1) {
-                    found = false;
-                    break;
+    void patternScan(void* module, const Scanner::Pattern& pattern, std::vector<uint64_t>* address)
+    {
+        for (const auto& region : getModuleRegions(module)) {
+            if (pattern.section == Scanner::Section::Any || pattern.section == region.section) {
+                Scanner::scan(region.data, region.size, pattern, address);
+            }
+        }
+    }
+
+    void patternScan(void* module, const std::vector<Scanner::Pattern>& patterns, std::vector<std::vector<uint64_t>>* address)
+    {
+        address->assign(patterns.size(), {});
+        for (const auto& region : getModuleRegions(module)) {
+            std::vector<const Scanner::Pattern*> subset;
+            std::vector<size_t> index;
+            for (size_t i = 0; i < patterns.size(); ++i) {
+                if (patterns[i].section == Scanner::Section::Any || patterns[i].section == region.section) {
+                    subset.push_back(&patterns[i]);
+                    index.push_back(i);
                 }
             }
-            if (found) {
-                address->push_back((uint64_t)&scanBytes[i]);
+            if (subset.empty()) {
+                continue;
+            }
+            std::vector<std::vector<uint64_t>> hits;
+            Scanner::scanBatchParallel(region.data, region.size, subset, &hits);
+            for (size_t i = 0; i < subset.size(); ++i) {
+                auto& target = (*address)[index[i]];
+                target.insert(target.end(), hits[i].begin(), hits[i].end());
             }
         }
     }
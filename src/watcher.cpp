@@ -0,0 +1,279 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <windows.h>
+#include <winternl.h>
+#include <vector>
+#include <string>
+#include <filesystem>
+#include <cstdint>
+
+#include "watcher.hpp"
+
+namespace
+{
+    // The loader notification API lives in ntdll and is not part of the SDK headers
+    constexpr ULONG LDR_DLL_NOTIFICATION_REASON_LOADED = 1;
+    constexpr ULONG LDR_DLL_NOTIFICATION_REASON_UNLOADED = 2;
+
+    typedef struct LDR_DLL_NOTIFICATION_DATA {
+        ULONG Flags;
+        PCUNICODE_STRING FullDllName;
+        PCUNICODE_STRING BaseDllName;
+        PVOID DllBase;
+        ULONG SizeOfImage;
+    } LDR_DLL_NOTIFICATION_DATA;
+
+    typedef VOID (CALLBACK* LdrDllNotification_t)(ULONG, const LDR_DLL_NOTIFICATION_DATA*, PVOID);
+    typedef NTSTATUS (NTAPI* LdrRegisterDllNotification_t)(ULONG, LdrDllNotification_t, PVOID, PVOID*);
+
+    // Events are queued from inside the loader lock, so the queue is a fixed ring that never allocates
+    constexpr size_t QUEUE_SIZE = 64;
+
+    std::vector<std::wstring> watchTable;
+    Watcher::event_t queue[QUEUE_SIZE];
+    size_t queueHead = 0;
+    size_t queueCount = 0;
+    SRWLOCK queueLock = SRWLOCK_INIT;
+    HANDLE queueSemaphore = NULL;
+    HANDLE releaseEvent = NULL;
+    uint32_t sequence = 0;
+    volatile LONG releasedSequence = 0;
+    // Last unload the fix thread claimed, and the last one the loader stopped waiting for,
+    // both only change under `queueLock`
+    uint32_t claimedSequence = 0;
+    uint32_t expiredSequence = 0;
+    PVOID cookie = NULL;
+    Watcher::mapped_t mappedCallback = nullptr;
+    std::wstring fileDirectory;
+    std::wstring fileName;
+
+    bool push(Watcher::Reason reason, HMODULE module, size_t index, bool unique = false, uint32_t* queuedSequence = nullptr) {
+        bool queued = false;
+        AcquireSRWLockExclusive(&queueLock);
+        bool duplicate = false;
+        for (size_t i = 0; unique && i < queueCount; ++i) {
+            const Watcher::event_t& event = queue[(queueHead + i) % QUEUE_SIZE];
+            if (event.reason == reason && event.module == module) {
+                duplicate = true;
+                break;
+            }
+        }
+        if (!duplicate && queueCount < QUEUE_SIZE) {
+            sequence++;
+            queue[(queueHead + queueCount) % QUEUE_SIZE] = { reason, module, index, sequence };
+            queueCount++;
+            queued = true;
+            if (queuedSequence != nullptr) {
+                *queuedSequence = sequence;
+            }
+        }
+        ReleaseSRWLockExclusive(&queueLock);
+        if (queued) {
+            ReleaseSemaphore(queueSemaphore, 1, NULL);
+        }
+        return queued;
+    }
+
+    size_t lookup(PCUNICODE_STRING name) {
+        size_t length = name->Length / sizeof(WCHAR);
+        for (size_t i = 0; i < watchTable.size(); ++i) {
+            if (watchTable[i].size() == length && _wcsnicmp(watchTable[i].c_str(), name->Buffer, length) == 0) {
+                return i;
+            }
+        }
+        return SIZE_MAX;
+    }
+
+    bool isWatchedFile(const FILE_NOTIFY_INFORMATION* info) {
+        size_t length = info->FileNameLength / sizeof(WCHAR);
+        return fileName.size() == length && _wcsnicmp(fileName.c_str(), info->FileName, length) == 0;
+    }
+
+    DWORD WINAPI fileWatch(LPVOID parameter) {
+        HANDLE directory = (HANDLE)parameter;
+        alignas(DWORD) BYTE buffer[4096];
+        DWORD received = 0;
+        while (ReadDirectoryChangesW(
+            directory, buffer, sizeof(buffer), FALSE,
+            FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME, &received, NULL, NULL
+        )) {
+            // A zero sized result means the buffer overflowed, treat it as a change to be safe
+            bool changed = received == 0;
+            for (DWORD offset = 0; !changed && offset < received;) {
+                const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)(buffer + offset);
+                changed = isWatchedFile(info);
+                if (info->NextEntryOffset == 0) {
+                    break;
+                }
+                offset += info->NextEntryOffset;
+            }
+            if (changed) {
+                Sleep(Watcher::SETTLE_TIME);
+                Watcher::notify();
+            }
+        }
+        CloseHandle(directory);
+        return 0;
+    }
+
+    VOID CALLBACK notification(ULONG reason, const LDR_DLL_NOTIFICATION_DATA* data, PVOID context) {
+        size_t index = lookup(data->BaseDllName);
+        if (index == SIZE_MAX) {
+            return;
+        }
+        if (reason == LDR_DLL_NOTIFICATION_REASON_LOADED) {
+            if (mappedCallback != nullptr) {
+                mappedCallback((HMODULE)data->DllBase, index, true);
+            }
+            push(Watcher::Reason::Loaded, (HMODULE)data->DllBase, index);
+        }
+        else if (reason == LDR_DLL_NOTIFICATION_REASON_UNLOADED) {
+            // Hold the loader until the module has been released, it is unmapped once we return
+            uint32_t unloadSequence = 0;
+            if (push(Watcher::Reason::Unloaded, (HMODULE)data->DllBase, index, false, &unloadSequence)) {
+                ULONGLONG deadline = GetTickCount64() + Watcher::RELEASE_TIMEOUT;
+                while ((uint32_t)releasedSequence < unloadSequence) {
+                    ULONGLONG now = GetTickCount64();
+                    DWORD timeout = now >= deadline ? 0 : (DWORD)(deadline - now);
+                    if (timeout > 0 && WaitForSingleObject(releaseEvent, timeout) == WAIT_OBJECT_0) {
+                        continue;
+                    }
+                    // Out of time, give up unless the fix thread is already tearing the module down
+                    AcquireSRWLockExclusive(&queueLock);
+                    bool claimed = claimedSequence >= unloadSequence;
+                    if (!claimed) {
+                        expiredSequence = unloadSequence;
+                    }
+                    ReleaseSRWLockExclusive(&queueLock);
+                    if (!claimed) {
+                        break;
+                    }
+                    while ((uint32_t)releasedSequence < unloadSequence) {
+                        WaitForSingleObject(releaseEvent, INFINITE);
+                    }
+                }
+            }
+        }
+    }
+}
+
+namespace Watcher
+{
+    bool init(const std::vector<std::string>& modules, mapped_t mapped) {
+        mappedCallback = mapped;
+        for (const auto& module : modules) {
+            watchTable.emplace_back(module.begin(), module.end());
+        }
+        queueSemaphore = CreateSemaphoreW(NULL, 0, QUEUE_SIZE, NULL);
+        releaseEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+        if (queueSemaphore == NULL || releaseEvent == NULL) {
+            return false;
+        }
+
+        auto ldrRegisterDllNotification = (LdrRegisterDllNotification_t)GetProcAddress(
+            GetModuleHandleW(L"ntdll.dll"), "LdrRegisterDllNotification"
+        );
+        if (ldrRegisterDllNotification == NULL || ldrRegisterDllNotification(0, notification, NULL, &cookie) != 0) {
+            return false;
+        }
+
+        // Pick up anything that was mapped before the notification was registered, the
+        // notification may have already queued it if it raced with registration
+        for (size_t i = 0; i < watchTable.size(); ++i) {
+            HMODULE module = GetModuleHandleW(watchTable[i].c_str());
+            if (module != NULL) {
+                if (mappedCallback != nullptr) {
+                    mappedCallback(module, i, false);
+                }
+                push(Reason::Loaded, module, i, true);
+            }
+        }
+        return true;
+    }
+
+    event_t wait() {
+        WaitForSingleObject(queueSemaphore, INFINITE);
+        AcquireSRWLockExclusive(&queueLock);
+        event_t event = queue[queueHead];
+        queueHead = (queueHead + 1) % QUEUE_SIZE;
+        queueCount--;
+        ReleaseSRWLockExclusive(&queueLock);
+        return event;
+    }
+
+    void notify() {
+        push(Reason::Notified, NULL, SIZE_MAX, true);
+    }
+
+    bool watchFile(const std::string& path) {
+        std::error_code error;
+        std::filesystem::path file = std::filesystem::absolute(path, error);
+        if (error || !fileName.empty()) {
+            return false;
+        }
+        fileDirectory = file.parent_path().wstring();
+        fileName = file.filename().wstring();
+
+        HANDLE directory = CreateFileW(
+            fileDirectory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL
+        );
+        HANDLE thread = NULL;
+        if (directory != INVALID_HANDLE_VALUE) {
+            thread = CreateThread(NULL, 0, fileWatch, directory, 0, NULL);
+            if (thread == NULL) {
+                CloseHandle(directory);
+            }
+        }
+        if (thread == NULL) {
+            fileName.clear();
+            return false;
+        }
+        CloseHandle(thread);
+        return true;
+    }
+
+    bool claim(const event_t& event) {
+        if (event.reason != Reason::Unloaded) {
+            return false;
+        }
+        AcquireSRWLockExclusive(&queueLock);
+        bool held = expiredSequence < event.sequence;
+        if (held) {
+            claimedSequence = event.sequence;
+        }
+        ReleaseSRWLockExclusive(&queueLock);
+        return held;
+    }
+
+    void release(const event_t& event) {
+        if (event.reason != Reason::Unloaded) {
+            return;
+        }
+        InterlockedExchange(&releasedSequence, (LONG)event.sequence);
+        SetEvent(releaseEvent);
+    }
+}